@@ -1,8 +1,53 @@
-﻿#include <filesystem>
+﻿#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
 #include <random>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define HULL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HULL_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GNUC__)
+#define HULL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define HULL_TARGET(isa)
+#endif
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -19,14 +64,37 @@ const double kAnime = 0.1; // dt between solver steps
 const unsigned int kWinWidth = 900;
 const unsigned int kWinHeight = 900;
 const std::string out_dir = "out";
+const float kClearColor[3] = {0.07f, 0.13f, 0.17f};
+// packed RGBA8, red in the low byte: the byte order GL reads a GL_UNSIGNED_BYTE color in on little-endian hosts
+constexpr uint32_t Rgba(float r, float g, float b, float a) 
+{
+  return uint32_t(r*255.0f+0.5f) | uint32_t(g*255.0f+0.5f) << 8 | uint32_t(b*255.0f+0.5f) << 16 | uint32_t(a*255.0f+0.5f) << 24;
+}
+const uint32_t kPointColor = Rgba(1.0f, 1.0f, 1.0f, 1.0f);
+const uint32_t kHullColor = Rgba(0.0f, 1.0f, 0.0f, 1.0f);
+const uint32_t kLastColor = Rgba(1.0f, 0.0f, 1.0f, 0.1f); // newest hull point, its line and the mean
+const uint32_t kStaleColor = Rgba(0.3f, 0.36f, 0.4f, 1.0f); // points outside the sliding window
+const unsigned int kEncoderThreads = 4; // PNG encoders behind the render loop
+const unsigned int kFrameBuffers = 8; // captured frames in flight before the render loop waits
+const bool kPboCapture = true; // read saved frames back through a PBO ring instead of a blocking glReadPixels
+const unsigned int kPboSlots = 3;
+
+enum class HullEngine { kGiftWrap, kIncremental, kSlidingWindow, kMonotoneChain, kChan, kDivideAndConquer, kQuickHull };
+const HullEngine kEngine = HullEngine::kGiftWrap; // kGiftWrap, kIncremental and kSlidingWindow animate, others solve in one call
+const unsigned int kInsertSteps = 64; // steps kIncremental and kSlidingWindow spread the points' arrival over
+const unsigned int kWindowFraction = 4; // kSlidingWindow keeps the newest 1/kWindowFraction of the points
+const bool kPrefilter = true; // drop interior points before solving
+const unsigned int kLodRingsPerBlock = 8; // more points than this under one ring's footprint: draw the density heatmap
+const size_t kQuickHullCutoff = 1 << 15; // smaller QuickHull subproblems run serially
 
 const char *kVertexShaderSrc = R"(#version 330 core
 layout (location = 0) in vec2 pos;
-uniform vec4 color;
+layout (location = 1) in vec2 center;
+layout (location = 2) in vec4 color;
 out vec4 inColor;
 
 void main() {
-  gl_Position = vec4(pos, 0.0, 1.0);
+  gl_Position = vec4(pos+center, 0.0, 1.0);
   inColor = color;
 })";
 
@@ -38,26 +106,314 @@ void main() {
   FragColor = inColor;
 })";
 
-struct vec2f 
+// full-window quad from gl_VertexID, no vertex buffer
+const char *kHeatmapVertexShaderSrc = R"(#version 330 core
+out vec2 uv;
+
+void main() {
+  uv = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+  gl_Position = vec4(uv*2.0-1.0, 0.0, 1.0);
+})";
+
+const char *kHeatmapFragmentShaderSrc = R"(#version 330 core
+uniform sampler2D heatmap;
+in vec2 uv;
+out vec4 FragColor;
+
+void main() {
+  FragColor = texture(heatmap, uv);
+})";
+
+template <class T>
+struct vec2 
 {
-  float x,y;
+  T x,y;
 
-  vec2f operator+(const vec2f& v) const { return vec2f{x+v.x,y+v.y}; }
-  vec2f operator*(const float v) const { return vec2f{x*v,y*v}; }
-  vec2f operator-(const vec2f& v) const { return vec2f{x-v.x,y-v.y}; }
-  bool operator==(const vec2f& v) const { return std::abs(x-v.x) < 1e-9f && std::abs(y-v.y) < 1e-9f; }
+  vec2 operator+(const vec2& v) const { return vec2{x+v.x,y+v.y}; }
+  vec2 operator*(const T v) const { return vec2{x*v,y*v}; }
+  vec2 operator-(const vec2& v) const { return vec2{x-v.x,y-v.y}; }
+  bool operator==(const vec2& v) const { return x == v.x && y == v.y; }
+  bool operator!=(const vec2& v) const { return !(*this == v); }
 
-  float norm() const {return std::sqrt(x*x+y*y); }
+  T dot(const vec2& v) const { return x*v.x+y*v.y; }
+  T cross(const vec2& v) const { return x*v.y-y*v.x; }
+  T norm() const {return T(std::sqrt(x*x+y*y)); }
 };
+
+// Coordinate types the hull engines are instantiated for. The visualizer draws vec2f; the integer
+// variants are exact as long as |x|,|y| < 2^30 (int32_t, fixed point) and |x|,|y| < 2^62 (int64_t).
+using vec2f = vec2<float>;
+using vec2d = vec2<double>;
+using vec2i = vec2<int32_t>;
+using vec2l = vec2<int64_t>;
+
+// Point type held by a container of points (std::vector or PointSet).
+template <class Points>
+using PointOf = typename Points::value_type;
     
+template <class T, size_t Align = 64>
+struct AlignedAllocator 
+{
+  using value_type = T;
+  template <class U> struct rebind { using other = AlignedAllocator<U, Align>; };
+
+  AlignedAllocator() = default;
+  template <class U> AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+  T* allocate(size_t n) { return static_cast<T*>(::operator new(n*sizeof(T), std::align_val_t(Align))); }
+  void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(Align)); }
+  bool operator==(const AlignedAllocator&) const { return true; }
+  bool operator!=(const AlignedAllocator&) const { return false; }
+};
+
+template <class T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+// Points as structure of arrays: 64-byte aligned x and y, plus an optional index array that keeps every
+// point's position in the original input through compaction. Indexing and iteration hand out vec2<T> by
+// value, so code written against std::vector<vec2<T>> reads a PointSet without copying it to AoS.
+template <class T>
+struct PointSet 
+{
+  using value_type = vec2<T>;
+
+  AlignedVector<T> x, y;
+  std::vector<size_t> index; // empty unless track_index() was called
+
+  class const_iterator 
+  {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = vec2<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = vec2<T>;
+
+    const_iterator(const PointSet *set = nullptr, size_t i = 0) : set_(set), i_(i) {}
+    vec2<T> operator*() const { return (*set_)[i_]; }
+    vec2<T> operator[](difference_type d) const { return (*set_)[size_t(difference_type(i_)+d)]; }
+    const_iterator& operator++() { ++i_; return *this; }
+    const_iterator& operator--() { --i_; return *this; }
+    const_iterator operator++(int) { return const_iterator(set_, i_++); }
+    const_iterator operator--(int) { return const_iterator(set_, i_--); }
+    const_iterator& operator+=(difference_type d) { i_ = size_t(difference_type(i_)+d); return *this; }
+    const_iterator& operator-=(difference_type d) { i_ = size_t(difference_type(i_)-d); return *this; }
+    const_iterator operator+(difference_type d) const { return const_iterator(set_, size_t(difference_type(i_)+d)); }
+    const_iterator operator-(difference_type d) const { return const_iterator(set_, size_t(difference_type(i_)-d)); }
+    difference_type operator-(const const_iterator& it) const { return difference_type(i_)-difference_type(it.i_); }
+    bool operator==(const const_iterator& it) const { return i_ == it.i_; }
+    bool operator!=(const const_iterator& it) const { return i_ != it.i_; }
+    bool operator<(const const_iterator& it) const { return i_ < it.i_; }
+    bool operator>(const const_iterator& it) const { return i_ > it.i_; }
+    bool operator<=(const const_iterator& it) const { return i_ <= it.i_; }
+    bool operator>=(const const_iterator& it) const { return i_ >= it.i_; }
+
+  private:
+    const PointSet *set_;
+    size_t i_;
+  };
+
+  size_t size() const { return x.size(); }
+  bool empty() const { return x.empty(); }
+  value_type operator[](size_t i) const { return value_type{x[i], y[i]}; }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, size()); }
+
+  void reserve(size_t n) 
+  {
+    x.reserve(n);
+    y.reserve(n);
+  }
+
+  void clear() 
+  {
+    x.clear();
+    y.clear();
+    index.clear();
+  }
+
+  void push_back(const value_type& pt) 
+  {
+    if (track_) index.emplace_back(x.size());
+    x.emplace_back(pt.x);
+    y.emplace_back(pt.y);
+  }
+
+  // Starts recording input positions; points already present get 0..size()-1.
+  void track_index() 
+  {
+    track_ = true;
+    index.resize(size());
+    for (size_t i = 0; i < index.size(); ++i) index[i] = i;
+  }
+
+  // Stable in-place compaction of x, y and index to the points pred rejects; returns the number removed.
+  template <class Pred>
+  size_t remove_if(Pred pred) 
+  {
+    size_t k = 0;
+    for (size_t i = 0; i < size(); ++i)
+    {
+      if (pred(value_type{x[i], y[i]})) continue;
+      x[k] = x[i];
+      y[k] = y[i];
+      if (track_) index[k] = index[i];
+      ++k;
+    }
+    const size_t removed = size()-k;
+    x.resize(k);
+    y.resize(k);
+    if (track_) index.resize(k);
+    return removed;
+  }
+
+private:
+  bool track_ = false;
+};
+
+template <class T, class Pred>
+size_t RemoveIf(std::vector<vec2<T>> &pts, Pred pred) 
+{
+  const size_t before = pts.size();
+  pts.erase(std::remove_if(pts.begin(), pts.end(), pred), pts.end());
+  return before-pts.size();
+}
+
+template <class T, class Pred>
+size_t RemoveIf(PointSet<T> &pts, Pred pred) 
+{
+  return pts.remove_if(pred);
+}
+
+// IEEE value stored little-endian at p, whatever the host's byte order
+template <class T>
+T LoadLittleEndian(const char *p) 
+{
+  using Bits = typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type;
+  Bits bits = 0;
+  for (size_t b = 0; b < sizeof(T); ++b) bits |= Bits(static_cast<unsigned char>(p[b])) << (8*b);
+  T value;
+  std::memcpy(&value, &bits, sizeof(T));
+  return value;
+}
+
+// Read-only view of a raw point file (little-endian x,y pairs of T, as the .f32/.f64 loaders read) through
+// a private mapping: nothing is copied, pages come and go through the page cache. Reads the way PointSet
+// does, so the hull engines take it as it is. The mapping is advised sequential; Release hands back the
+// pages of a range once it has been read.
+template <class T>
+class MappedPoints 
+{
+public:
+  using value_type = vec2<T>;
+
+  MappedPoints() = default;
+  MappedPoints(const MappedPoints &) = delete;
+  MappedPoints &operator=(const MappedPoints &) = delete;
+
+  ~MappedPoints() 
+  {
+#ifdef HULL_MMAP
+    if (data_) munmap(const_cast<char *>(data_), bytes_);
+#endif
+  }
+
+  bool Open(const std::string &path) 
+  {
+#ifdef HULL_MMAP
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < off_t(2*sizeof(T)))
+    {
+      close(fd);
+      return false;
+    }
+    bytes_ = size_t(st.st_size);
+    void *map = mmap(NULL, bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+    madvise(map, bytes_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char *>(map);
+    size_ = bytes_/(2*sizeof(T));
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  value_type operator[](size_t i) const 
+  {
+    return value_type{LoadLittleEndian<T>(data_+2*sizeof(T)*i), LoadLittleEndian<T>(data_+(2*i+1)*sizeof(T))};
+  }
+
+  // Drops the mapping's whole pages within points [first, last); the file stays in the page cache.
+  void Release(size_t first, size_t last) const 
+  {
+#ifdef HULL_MMAP
+    const size_t page = size_t(sysconf(_SC_PAGESIZE));
+    const size_t from = (2*sizeof(T)*first+page-1)/page*page, to = 2*sizeof(T)*last/page*page;
+    if (from < to) madvise(const_cast<char *>(data_)+from, to-from, MADV_DONTNEED);
+#else
+    (void)first;
+    (void)last;
+#endif
+  }
+
+private:
+  const char *data_ = nullptr;
+  size_t bytes_ = 0, size_ = 0;
+};
+
+// Hint that points [first, last) of pts won't be read again; only a mapping has anything to give back.
+template <class Points>
+void ReleasePoints(const Points &, size_t, size_t) {}
+
+template <class T>
+void ReleasePoints(const MappedPoints<T> &pts, size_t first, size_t last) 
+{
+  pts.Release(first, last);
+}
+
 GLFWwindow* window;
-std::vector<vec2f> points;
+PointSet<float> points;
 vec2f mean{0.0f,0.0f};
 std::vector<vec2f> line_segments;
-std::vector<float> vertices;
-std::vector<float> vertices_d;
-unsigned int VBO, VAO, VBOd, VAOd;
-unsigned int shader_program;
+std::vector<float> vertices; // ring mesh shared by every point
+std::vector<float> centers; // per-instance point centers
+std::vector<uint32_t> center_colors; // per-instance point colors
+bool center_colors_changed = false; // set by the solver when the colors need uploading again
+unsigned int VBO, VBOc, VBOcc, VAO, VBOd, VBOdc, VAOd, VAOh;
+unsigned int shader_program, heatmap_program, heatmap_texture;
+bool lod = false; // points drawn as the density heatmap instead of rings
+std::vector<uint32_t> heatmap; // RGBA8 texels of the window, bottom row first
+bool headless = false; // no GL context: frames go through the software rasterizer
+std::string input_path; // points file given with --input, random points when empty
+std::string input_format; // --format: text, f32 or f64 in place of the input's extension
+bool stream_input = false; // --stream: the input goes through a running hull instead of into memory
+
+unsigned int MakeProgram(const char *vertex_src, const char *fragment_src) 
+{
+  unsigned int vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(vertex_shader, 1, &vertex_src, NULL);
+  glCompileShader(vertex_shader);
+
+  unsigned int fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+  glShaderSource(fragment_shader, 1, &fragment_src, NULL);
+  glCompileShader(fragment_shader);
+
+  unsigned int program = glCreateProgram();
+  glAttachShader(program, vertex_shader);
+  glAttachShader(program, fragment_shader);
+  glLinkProgram(program);
+
+  glDeleteShader(vertex_shader);
+  glDeleteShader(fragment_shader);
+  return program;
+}
 
 void MakeWindow(unsigned int width, unsigned int height, const char *title) 
 {
@@ -75,71 +431,174 @@ void MakeWindow(unsigned int width, unsigned int height, const char *title)
   glfwMakeContextCurrent(window);
 
   gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
-  glClearColor(0.07f, 0.13f, 0.17f, 1.0f);
+  glClearColor(kClearColor[0], kClearColor[1], kClearColor[2], 1.0f);
   glViewport(0, 0, width, height);
   glEnable(GL_MULTISAMPLE);
 
-  unsigned int vertex_shader = glCreateShader(GL_VERTEX_SHADER);
-  glShaderSource(vertex_shader, 1, &kVertexShaderSrc, NULL);
-  glCompileShader(vertex_shader);
-
-  unsigned int fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
-  glShaderSource(fragment_shader, 1, &kFragmentShaderSrc, NULL);
-  glCompileShader(fragment_shader);
+  shader_program = MakeProgram(kVertexShaderSrc, kFragmentShaderSrc);
+  heatmap_program = MakeProgram(kHeatmapVertexShaderSrc, kHeatmapFragmentShaderSrc);
+}
 
-  shader_program = glCreateProgram();
-  glAttachShader(shader_program, vertex_shader);
-  glAttachShader(shader_program, fragment_shader);
-  glLinkProgram(shader_program);
+// sin and cos for compile-time tables: Taylor series, x in [-pi, pi]
+constexpr double ConstSin(double x) 
+{
+  double term = x, sum = x;
+  for (int k = 1; k < 20; ++k)
+  {
+    term *= -x*x/double((2*k)*(2*k+1));
+    sum += term;
+  }
+  return sum;
+}
 
-  glDeleteShader(vertex_shader);
-  glDeleteShader(fragment_shader);
+constexpr double ConstCos(double x) 
+{
+  double term = 1.0, sum = 1.0;
+  for (int k = 1; k < 20; ++k)
+  {
+    term *= -x*x/double((2*k-1)*(2*k));
+    sum += term;
+  }
+  return sum;
 }
 
-void DrawPoint(const vec2f &center, std::vector<float> &container) 
+const float kRingOuter = 0.02f;
+const float kRingInner = 0.015f;
+
+// Triangle strip of a ring around the origin, 4 vertices per node: the outer and inner circle at node j, then
+// at node j-1. DrawPoint only adds the center.
+template <unsigned int Nodes>
+constexpr std::array<float, 8*Nodes> MakeRing() 
 {
-  const float r1 = 0.02f;
-  const float r2 = 0.015f;
-  vec2f A = center + vec2f{r1,0};
-  vec2f B = center + vec2f{r2,0};
-  for (unsigned int j=1; j<=kPointNodes; ++j)
+  std::array<float, 8*Nodes> ring{};
+  const double kPi = 3.14159265358979323846;
+  for (unsigned int j = 1; j <= Nodes; ++j)
   {
-    const float ang = 2*PI*j/float(kPointNodes);
-    vec2f dir = {std::cos(ang),std::sin(ang)};
-    vec2f C = center + dir*r1;
-    vec2f D = center + dir*r2;
+    // angles past pi wrap to the negative side, where the series converges; the last node is exactly 0
+    const double ang = j == Nodes ? 0.0 : (2*j <= Nodes ? 2*kPi*j/Nodes : 2*kPi*j/Nodes-2*kPi);
+    const double prev = j == 1 ? 0.0 : (2*(j-1) <= Nodes ? 2*kPi*(j-1)/Nodes : 2*kPi*(j-1)/Nodes-2*kPi);
+    const double c = ConstCos(ang), s = ConstSin(ang), pc = ConstCos(prev), ps = ConstSin(prev);
+    const float node[8] = {float(c*kRingOuter), float(s*kRingOuter), float(pc*kRingOuter), float(ps*kRingOuter),
+                           float(c*kRingInner), float(s*kRingInner), float(pc*kRingInner), float(ps*kRingInner)};
+    for (unsigned int k = 0; k < 8; ++k) ring[8*(j-1)+k] = node[k];
+  }
+  return ring;
+}
+
+template <unsigned int Nodes>
+constexpr std::array<float, 8*Nodes> kRingTemplate = MakeRing<Nodes>();
 
-    std::vector<float> line = {C.x,C.y,A.x,A.y,D.x,D.y,B.x,B.y};
-    std::copy(line.begin(), line.end(), std::back_inserter(container));
+const size_t kRingVertices = 4*kPointNodes;
+const size_t kLineVertices = 4;
 
-    A = C;
-    B = D;
+// Writes the 2*kRingVertices floats of a point's ring to out.
+void DrawPoint(const vec2f &center, float *out) 
+{
+  const auto &ring = kRingTemplate<kPointNodes>;
+  for (size_t i = 0; i < ring.size(); i += 2)
+  {
+    out[i] = ring[i]+center.x;
+    out[i+1] = ring[i+1]+center.y;
   }
 }
 
-void DrawLine(const vec2f &pt1, const vec2f &pt2, std::vector<float> &container) 
+void DrawPoint(const vec2f &center, std::vector<float> &container) 
+{
+  const size_t at = container.size();
+  container.resize(at+2*kRingVertices);
+  DrawPoint(center, container.data()+at);
+}
+
+// Writes the 2*kLineVertices floats of a line's strip to out.
+void DrawLine(const vec2f &pt1, const vec2f &pt2, float *out) 
 {
   const float d = 0.01f;
 
   vec2f v = pt2-pt1;
   vec2f n = {-v.y,v.x};
   float norm = n.norm();
-  if (norm == 0.0f) return;
-  vec2f p = n*(d/(2.0f*norm));
+  // a zero-length line still takes its four vertices, collapsed, so vertex offsets stay fixed
+  vec2f p = norm == 0.0f ? vec2f{0.0f,0.0f} : n*(d/(2.0f*norm));
 
   vec2f A = pt1 + p;
   vec2f B = pt1 - p;
   vec2f C = pt2 - p;
   vec2f D = pt2 + p;
 
-  std::vector<float> line = {C.x,C.y,A.x,A.y,D.x,D.y,B.x,B.y};
-  std::copy(line.begin(), line.end(), std::back_inserter(container));
+  const float line[8] = {C.x,C.y,A.x,A.y,D.x,D.y,B.x,B.y};
+  std::copy(line, line+8, out);
+}
+
+void DrawLine(const vec2f &pt1, const vec2f &pt2, std::vector<float> &container) 
+{
+  const size_t at = container.size();
+  container.resize(at+2*kLineVertices);
+  DrawLine(pt1, pt2, container.data()+at);
+}
+
+void Upload(unsigned int vao, unsigned int vbo, const std::vector<float> &data) 
+{
+  glBindVertexArray(vao);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  glBufferData(GL_ARRAY_BUFFER, data.size()*sizeof(float), data.data(), GL_STATIC_DRAW);
+
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2*sizeof(float), (void*)0);
+  glEnableVertexAttribArray(0);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0); 
+
+  glBindVertexArray(0); 
+}
+
+// Instance centers of the mesh in vao: attribute 1 advances once per instance. VAOs without it read the
+// default (0,0), so the overlay draws its vertices as they are.
+void UploadCenters(unsigned int vao, unsigned int vbo, const std::vector<float> &data) 
+{
+  glBindVertexArray(vao);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  glBufferData(GL_ARRAY_BUFFER, data.size()*sizeof(float), data.data(), GL_STATIC_DRAW);
+
+  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2*sizeof(float), (void*)0);
+  glVertexAttribDivisor(1, 1);
+  glEnableVertexAttribArray(1);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0); 
+
+  glBindVertexArray(0); 
+}
+
+// Instance colors of the mesh in vao, attribute 2, one RGBA8 per instance like the centers.
+void UploadCenterColors(unsigned int vao, unsigned int vbo, const std::vector<uint32_t> &data) 
+{
+  glBindVertexArray(vao);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  glBufferData(GL_ARRAY_BUFFER, data.size()*sizeof(uint32_t), data.data(), GL_STATIC_DRAW);
+
+  glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(uint32_t), (void*)0);
+  glVertexAttribDivisor(2, 1);
+  glEnableVertexAttribArray(2);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0); 
+
+  glBindVertexArray(0); 
+}
+
+// Heatmap texels as the texture's single level, sampled nearest so texels stay pixels.
+void UploadHeatmap(unsigned int texture, const std::vector<uint32_t> &texels, unsigned int width, unsigned int height) 
+{
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, GLsizei(width), GLsizei(height), 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+  glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void GenerateData() 
 {
   points.reserve(kSamples);
-  vertices.reserve(2*4*kPointNodes*kSamples);
 
   std::random_device rd;
   std::mt19937 gen(rd());
@@ -147,172 +606,4515 @@ void GenerateData()
   for (unsigned int i=0; i<kSamples; ++i) 
   {
     vec2f pt = {dist(gen),dist(gen)};
-    DrawPoint(pt, vertices);
     mean = mean + pt*(1.0f/float(kSamples));
-    points.emplace_back(pt);
+    points.push_back(pt);
   }
+}
 
-  glBindVertexArray(VAO);
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, vertices.size()*sizeof(float), vertices.data(), GL_STATIC_DRAW);
+std::atomic<unsigned long long> exact_predicates{0}; // predicate calls the double filter could not decide
 
-  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2*sizeof(float), (void*)0);
-  glEnableVertexAttribArray(0);
+// Sign of a sum of doubles, exact: Shewchuk's grow-expansion keeps the running sum as non-overlapping
+// components in increasing magnitude, so the largest one carries the sign.
+int ExactSign(const double *terms, unsigned int count) 
+{
+  double e[16];
+  unsigned int m = 0;
+  for (unsigned int t = 0; t < count; ++t)
+  {
+    double q = terms[t];
+    unsigned int k = 0;
+    for (unsigned int i = 0; i < m; ++i)
+    {
+      const double sum = q+e[i];
+      const double b_virt = sum-q;
+      const double err = (q-(sum-b_virt))+(e[i]-b_virt);
+      if (err != 0.0) e[k++] = err;
+      q = sum;
+    }
+    if (q != 0.0) e[k++] = q;
+    m = k;
+  }
+  return m ? (e[m-1] > 0.0)-(e[m-1] < 0.0) : 0;
+}
 
-  glBindBuffer(GL_ARRAY_BUFFER, 0); 
+// Exact sign of the sum of f[i][0]*f[i][1]. A float product is exact in double; a double product is
+// split into its rounded value and the rounding error recovered by a fused multiply-add.
+template <class T>
+int ProductSumSign(const T (&f)[8][2]) 
+{
+  double terms[16];
+  unsigned int count = 0;
+  for (const auto &p : f)
+  {
+    const double prod = double(p[0])*p[1];
+    terms[count++] = prod;
+    if constexpr (std::is_same_v<T, double>) terms[count++] = std::fma(p[0], p[1], -prod);
+  }
+  return ExactSign(terms, count);
+}
 
-  glBindVertexArray(0); 
+// Sign of a*b-c*d for 64-bit integers, through 128-bit products: native where the compiler has them,
+// otherwise built from 32-bit halves.
+int ProductDiffSign(int64_t a, int64_t b, int64_t c, int64_t d) 
+{
+#if defined(__SIZEOF_INT128__)
+  const __int128 det = (__int128)(a)*b-(__int128)(c)*d;
+  return (det > 0)-(det < 0);
+#else
+  auto mul = [](int64_t u, int64_t v) {
+    const bool neg = (u < 0) != (v < 0);
+    const uint64_t mu = u < 0 ? 0-uint64_t(u) : uint64_t(u), mv = v < 0 ? 0-uint64_t(v) : uint64_t(v);
+    const uint64_t ll = (mu & 0xffffffff)*(mv & 0xffffffff), lh = (mu & 0xffffffff)*(mv >> 32);
+    const uint64_t hl = (mu >> 32)*(mv & 0xffffffff), hh = (mu >> 32)*(mv >> 32);
+    const uint64_t mid = (ll >> 32)+(lh & 0xffffffff)+(hl & 0xffffffff);
+    uint64_t lo = (mid << 32) | (ll & 0xffffffff);
+    uint64_t hi = hh+(lh >> 32)+(hl >> 32)+(mid >> 32);
+    if (neg)
+    {
+      lo = ~lo+1;
+      hi = ~hi+(lo == 0);
+    }
+    return std::make_pair(int64_t(hi), lo);
+  };
+  const auto l = mul(a, b), r = mul(c, d);
+  return (l > r)-(l < r);
+#endif
 }
 
-bool SolverStep() 
+// Shewchuk's orient2d bound for l-r (or l+r) evaluated in double from float or double inputs.
+const double kPredicateErrBound = (3.0+16.0*0x1p-53)*0x1p-53;
+
+// Exact path of Orient for floating-point coordinates: (b-a) x (d-c) expanded into eight products.
+template <class T>
+int OrientExact(const vec2<T> &a, const vec2<T> &b, const vec2<T> &c, const vec2<T> &d) 
 {
-  if (line_segments.size() > 1)
+  exact_predicates.fetch_add(1, std::memory_order_relaxed);
+  const T f[8][2] = {
+    {b.x, d.y}, {-b.x, c.y}, {-a.x, d.y}, {a.x, c.y}, {-b.y, d.x}, {b.y, c.x}, {a.y, d.x}, {-a.y, c.x}};
+  return ProductSumSign(f);
+}
+
+// Sign of (b-a) x (d-c). Floating-point coordinates go through the double filter and fall back to the
+// exact expansion inside its rounding bound; integer coordinates are exact in wider integers.
+template <class T>
+inline int Orient(const vec2<T> &a, const vec2<T> &b, const vec2<T> &c, const vec2<T> &d) 
+{
+  if constexpr (std::is_same_v<T, int32_t>)
   {
-    for (unsigned int idx = 0; idx < line_segments.size()-1; ++idx) 
-      if (line_segments[line_segments.size()-1] == line_segments[idx]) 
-      {
-        if (idx == 0) return false;
-        else {
-          line_segments.erase(line_segments.begin(),line_segments.begin()+idx+1);
-          break;
-        }
-      }
+    const int64_t det = (int64_t(b.x)-a.x)*(int64_t(d.y)-c.y)-(int64_t(b.y)-a.y)*(int64_t(d.x)-c.x);
+    return (det > 0)-(det < 0);
   }
-  vertices_d.clear();
- 
-  if (line_segments.empty()) 
+  else if constexpr (std::is_same_v<T, int64_t>)
   {
-    line_segments.emplace_back(points[0]);
+    return ProductDiffSign(b.x-a.x, d.y-c.y, b.y-a.y, d.x-c.x);
   }
-  else 
+  else
   {
-    unsigned int lst =  unsigned int(line_segments.size())-1;
-    vec2f v1 = line_segments[lst]-mean;
-    unsigned int closest = 0;
-    float min_ang = 360.0f;
-    for (unsigned int idx = 0; idx < points.size(); ++idx)
-    {
-      const auto pt = points[idx];
-      vec2f v2 = pt-line_segments[lst];
-      if (v2.norm() == 0.0f) continue;
-      float dot = v1.x*v2.x+v1.y*v2.y;
-      float det = v1.x*v2.y-v1.y*v2.x;
-      float ang = atan2f(det,dot)*180.0f/PI;
-      if (ang < 0) ang = 180.f - ang;
-      if (ang < min_ang)
-      {
-        min_ang = ang;
-        closest = idx;
-      }
-    }
-    if (min_ang < 90 && lst == 0) line_segments[lst] = points[closest];
-    else line_segments.emplace_back(points[closest]);
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "unsupported coordinate type");
+    const double l = (double(b.x)-a.x)*(double(d.y)-c.y);
+    const double r = (double(b.y)-a.y)*(double(d.x)-c.x);
+    const double det = l-r;
+    const double bound = kPredicateErrBound*(std::abs(l)+std::abs(r));
+    if (det > bound) return 1;
+    if (det < -bound) return -1;
+    return OrientExact(a, b, c, d);
   }
+}
 
-  for (unsigned int i = 0; i < line_segments.size(); ++i)
-    DrawPoint(line_segments[i], vertices_d);
-  DrawPoint(mean, vertices_d); 
-  
-  for (unsigned int i = 1; i < line_segments.size(); ++i)
-    DrawLine(line_segments[i], line_segments[i-1], vertices_d);
-  DrawLine(mean,line_segments[line_segments.size()-1],vertices_d);
-
-  glBindVertexArray(VAOd);
-  glBindBuffer(GL_ARRAY_BUFFER, VBOd);
-  glBufferData(GL_ARRAY_BUFFER, vertices_d.size()*sizeof(float), vertices_d.data(), GL_STATIC_DRAW);
+// Sign of the turn o->a->b: 1 counter-clockwise, -1 clockwise, 0 collinear.
+template <class T>
+inline int Orient(const vec2<T> &o, const vec2<T> &a, const vec2<T> &b) 
+{
+  return Orient(o, a, o, b);
+}
 
-  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2*sizeof(float), (void*)0);
-  glEnableVertexAttribArray(0);
+// Sign of (b-a) . (d-c), filtered and exact like Orient.
+template <class T>
+int DotSign(const vec2<T> &a, const vec2<T> &b, const vec2<T> &c, const vec2<T> &d) 
+{
+  if constexpr (std::is_same_v<T, int32_t>)
+  {
+    const int64_t dot = (int64_t(b.x)-a.x)*(int64_t(d.x)-c.x)+(int64_t(b.y)-a.y)*(int64_t(d.y)-c.y);
+    return (dot > 0)-(dot < 0);
+  }
+  else if constexpr (std::is_same_v<T, int64_t>)
+  {
+    return ProductDiffSign(b.x-a.x, d.x-c.x, a.y-b.y, d.y-c.y);
+  }
+  else
+  {
+    const double l = (double(b.x)-a.x)*(double(d.x)-c.x);
+    const double r = (double(b.y)-a.y)*(double(d.y)-c.y);
+    const double dot = l+r;
+    const double bound = kPredicateErrBound*(std::abs(l)+std::abs(r));
+    if (dot > bound) return 1;
+    if (dot < -bound) return -1;
 
-  glBindBuffer(GL_ARRAY_BUFFER, 0); 
+    exact_predicates.fetch_add(1, std::memory_order_relaxed);
+    const T f[8][2] = {
+      {b.x, d.x}, {-b.x, c.x}, {-a.x, d.x}, {a.x, c.x}, {b.y, d.y}, {-b.y, c.y}, {-a.y, d.y}, {a.y, c.y}};
+    return ProductSumSign(f);
+  }
+}
 
-  glBindVertexArray(0); 
+// Sign of |c-o|-|b-o| for three coordinates on one axis, without rounding.
+template <class T>
+int AxisDistanceSign(T o, T b, T c) 
+{
+  const int c_side = (c > o)-(c < o), b_side = (b > o)-(b < o);
+  if (c_side == 0 || b_side == 0) return (c_side != 0)-(b_side != 0);
+  if (c_side == b_side) return c_side*((c > b)-(c < b));
+  if constexpr (std::is_integral_v<T>)
+  {
+    const int64_t dc = c_side*(int64_t(c)-o), db = b_side*(int64_t(b)-o);
+    return (dc > db)-(dc < db);
+  }
+  else
+  {
+    // opposite sides of o: |c-o|-|b-o| = c_side*(c+b-2o)
+    const double terms[4] = {double(c), double(b), -double(o), -double(o)};
+    return c_side*ExactSign(terms, 4);
+  }
+}
 
-  return true;
+// For o, b, c collinear: true if c is farther from o than b.
+template <class T>
+bool Farther(const vec2<T> &o, const vec2<T> &b, const vec2<T> &c) 
+{
+  if (const int dx = AxisDistanceSign(o.x, b.x, c.x)) return dx > 0;
+  return AxisDistanceSign(o.y, b.y, c.y) > 0;
 }
 
-int main()
+// The chain scan of Andrew's monotone chain alone, for [first,last) already sorted by x, then y, without
+// repeats. Writes the hull to out like MonotoneChain and returns its size.
+template <class E, class At>
+size_t MonotoneChainSorted(const E *first, const E *last, E *out, At at) 
 {
-  MakeWindow(kWinHeight, kWinWidth, "ConvexHull");
+  const size_t n = size_t(last-first);
+  if (n < 3)
+  {
+    std::copy(first, last, out);
+    return n;
+  }
 
-  glGenVertexArrays(1, &VAO);
-  glGenBuffers(1, &VBO);
-  glGenVertexArrays(1, &VAOd);
-  glGenBuffers(1, &VBOd);
+  size_t k = 0;
+  for (size_t i = 0; i < n; ++i)
+  {
+    while (k >= 2 && Orient(at(out[k-2]), at(out[k-1]), at(first[i])) <= 0) --k;
+    out[k++] = first[i];
+  }
+  for (size_t i = n-1, lower = k+1; i > 0; --i)
+  {
+    while (k >= lower && Orient(at(out[k-2]), at(out[k-1]), at(first[i-1])) <= 0) --k;
+    out[k++] = first[i-1];
+  }
+  return k-1;
+}
 
-  GenerateData();
+// Andrew's monotone chain, O(n log n). Sorts [first,last) in place and writes the hull counter-clockwise,
+// without collinear points, to out (room for last-first+1 elements). Returns the hull size. Elements are
+// whatever at() maps to a point, the points themselves or positions of points held elsewhere.
+template <class E, class At>
+size_t MonotoneChain(E *first, E *last, E *out, At at) 
+{
+  std::sort(first, last, [&](const E &ea, const E &eb) {
+    const auto a = at(ea), b = at(eb);
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+  });
+  last = std::unique(first, last, [&](const E &ea, const E &eb) { return at(ea) == at(eb); });
+  return MonotoneChainSorted(first, last, out, at);
+}
 
-  double prev_time = -kAnime;
+template <class T>
+size_t MonotoneChain(vec2<T> *first, vec2<T> *last, vec2<T> *out) 
+{
+  return MonotoneChain(first, last, out, [](const vec2<T> &p) -> const vec2<T> & { return p; });
+}
 
-  namespace fs = std::filesystem;
-  fs::remove_all(out_dir);
-  fs::create_directories(out_dir);
+template <class Points>
+std::vector<PointOf<Points>> MonotoneChain(const Points &pts) 
+{
+  std::vector<PointOf<Points>> work(pts.begin(), pts.end());
+  std::vector<PointOf<Points>> hull(work.size()+1);
+  hull.resize(MonotoneChain(work.data(), work.data()+work.size(), hull.data()));
+  return hull;
+}
 
-  int k = 0;
-  int k_saved = 0;
+// Octagon spanned by the extreme points of pts along x, y, x+y and x-y, counter-clockwise without repeats.
+// Returns its vertex count, under 3 when it encloses nothing.
+template <class Points>
+unsigned int ExtremeOctagon(const Points &pts, PointOf<Points> (&poly)[8]) 
+{
+  if (pts.size() == 0) return 0;
 
-  while (!glfwWindowShouldClose(window))
+  // left, lower-left, bottom, lower-right, right, upper-right, top, upper-left: counter-clockwise
+  using Point = PointOf<Points>;
+  Point ext[8];
+  std::fill(ext, ext+8, pts[0]);
+  // the diagonal keys only pick which points span the octagon, so rounding them is harmless
+  auto sum = [](const Point &p) { return double(p.x)+double(p.y); };
+  auto diff = [](const Point &p) { return double(p.x)-double(p.y); };
+  for (const auto &pt : pts)
   {
-    double current_time = glfwGetTime();
-    if (current_time-kAnime >= prev_time) 
-    {
-      k += int(SolverStep());
-      prev_time = current_time;
+    if (pt.x < ext[0].x) ext[0] = pt;
+    if (sum(pt) < sum(ext[1])) ext[1] = pt;
+    if (pt.y < ext[2].y) ext[2] = pt;
+    if (diff(pt) > diff(ext[3])) ext[3] = pt;
+    if (pt.x > ext[4].x) ext[4] = pt;
+    if (sum(pt) > sum(ext[5])) ext[5] = pt;
+    if (pt.y > ext[6].y) ext[6] = pt;
+    if (diff(pt) < diff(ext[7])) ext[7] = pt;
+  }
+
+  unsigned int count = 0;
+  for (unsigned int i = 0; i < 8; ++i)
+    if (count == 0 || ext[i] != poly[count-1]) poly[count++] = ext[i];
+  while (count > 1 && poly[count-1] == poly[0]) --count;
+  return count;
+}
+
+// True if pt lies strictly inside the counter-clockwise convex polygon poly[0..count), by testing every edge.
+template <class T>
+bool InsidePolygon(const vec2<T> *poly, size_t count, const vec2<T> &pt) 
+{
+  if (count < 3) return false;
+  for (size_t i = 0; i < count; ++i)
+    if (Orient(poly[i], poly[i+1 == count ? 0 : i+1], pt) <= 0) return false;
+  return true;
+}
+
+// Same test in O(log h) for a counter-clockwise hull without collinear points: a binary search finds the
+// wedge of the fan from hull[0] holding pt, then its outer edge decides.
+template <class T>
+bool InsideHull(const std::vector<vec2<T>> &hull, const vec2<T> &pt) 
+{
+  const size_t h = hull.size();
+  if (h < 3) return false;
+  if (Orient(hull[0], hull[1], pt) <= 0 || Orient(hull[0], hull[h-1], pt) >= 0) return false;
+  size_t lo = 1, hi = h-1; // pt is left of hull[0]->hull[lo], right of hull[0]->hull[hi]
+  while (hi-lo > 1)
+  {
+    const size_t mid = (lo+hi)/2;
+    if (Orient(hull[0], hull[mid], pt) > 0) lo = mid;
+    else hi = mid;
+  }
+  return Orient(hull[lo], hull[hi], pt) > 0;
+}
+
+// Akl-Toussaint heuristic: one pass finds the extreme octagon, a second drops every point strictly inside
+// it. Compacts pts in place, returns the number discarded.
+template <class Points>
+size_t AklToussaint(Points &pts) 
+{
+  if (pts.size() < 4) return 0;
+  PointOf<Points> poly[8];
+  const unsigned int count = ExtremeOctagon(pts, poly);
+  if (count < 3) return 0;
+  return RemoveIf(pts, [&](const PointOf<Points> &pt) { return InsidePolygon(poly, count, pt); });
+}
+
+// Gift-wrapping successor rule: cand beats best if it lies right of cur->best, or on it but farther.
+template <class T>
+bool WrapsTighter(const vec2<T> &cur, const vec2<T> &best, const vec2<T> &cand) 
+{
+  const int turn = Orient(cur, best, cand);
+  if (turn != 0) return turn < 0;
+  return Farther(cur, best, cand);
+}
+
+// Jarvis march over the whole set, O(n*h). Batch form of the stepwise wrapper, kept as the baseline.
+template <class Points>
+std::vector<PointOf<Points>> GiftWrap(const Points &pts) 
+{
+  std::vector<PointOf<Points>> hull;
+  if (pts.empty()) return hull;
+
+  size_t start = 0;
+  for (size_t i = 1; i < pts.size(); ++i)
+    if (pts[i].x < pts[start].x || (pts[i].x == pts[start].x && pts[i].y < pts[start].y)) start = i;
+
+  size_t cur = start;
+  do
+  {
+    hull.emplace_back(pts[cur]);
+    size_t best = cur;
+    for (size_t i = 0; i < pts.size(); ++i)
+      if (WrapsTighter(pts[cur], pts[best], pts[i])) best = i;
+    cur = best;
+  } while (cur != start && hull.size() <= pts.size() && pts[cur] != pts[start]);
+  return hull;
+}
+
+// Vertex of the counter-clockwise polygon `hull` that has the whole polygon left of p->vertex, O(log h).
+// Of two such vertices on one ray from p the farther one is returned.
+template <class T>
+size_t Tangent(const vec2<T> *hull, size_t n, const vec2<T> &p) 
+{
+  auto is_tangent = [&](size_t c) {
+    return Orient(p, hull[c], hull[(c+n-1)%n]) >= 0 && Orient(p, hull[c], hull[(c+1)%n]) >= 0;
+  };
+
+  if (n > 3)
+  {
+    size_t l = 0, r = n;
+    int l_before = Orient(p, hull[0], hull[n-1]);
+    int l_after = Orient(p, hull[0], hull[1]);
+    while (l < r)
+    {
+      const size_t c = (l+r)/2;
+      const int c_before = Orient(p, hull[c], hull[(c+n-1)%n]);
+      const int c_after = Orient(p, hull[c], hull[(c+1)%n]);
+      const int c_side = Orient(p, hull[l], hull[c]);
+      if (c_before >= 0 && c_after >= 0) return WrapsTighter(p, hull[c], hull[(c+1)%n]) ? (c+1)%n : c;
+      if ((c_side > 0 && (l_after < 0 || l_before == l_after)) || (c_side < 0 && c_before < 0)) r = c;
+      else l = c+1;
+      l_before = -c_after;
+      l_after = Orient(p, hull[l%n], hull[(l+1)%n]);
+    }
+    if (is_tangent(l%n)) return WrapsTighter(p, hull[l%n], hull[(l+1)%n]) ? (l+1)%n : l%n;
+  }
+
+  // tiny polygons and float-degenerate configurations fall back to a linear scan
+  size_t best = 0;
+  for (size_t i = 1; i < n; ++i)
+    if (WrapsTighter(p, hull[best], hull[i])) best = i;
+  return best;
+}
+
+const size_t kChanFirstGroup = 16; // Chan's first sub-hull size; rounds of 4 cost more in tangents than they save
+
+// Chan's algorithm, O(n log h): gift wrapping over monotone-chain sub-hulls of size m with
+// binary-searched tangents, squaring m until the march closes within m steps. The sub-hulls lie back to
+// back in one buffer; a round hulls runs of the previous round's sub-hulls rather than their points, since
+// a point inside a group's hull is inside the hull of any group holding it, so later rounds sort only the
+// surviving vertices. Two buffers of n points are all the rounds allocate.
+template <class Points>
+std::vector<PointOf<Points>> Chan(const Points &pts) 
+{
+  using Point = PointOf<Points>;
+  const size_t n = pts.size();
+  if (n < 3) return MonotoneChain(pts);
+
+  Point start = pts[0];
+  for (const auto &pt : pts)
+    if (pt.x < start.x || (pt.x == start.x && pt.y < start.y)) start = pt;
+
+  // work holds the previous round's sub-hulls, group g at [offsets[g], offsets[g+1]); before the first
+  // round every point is a group of its own
+  std::vector<Point> work(pts.begin(), pts.end()), hulls;
+  std::vector<size_t> offsets, next_offsets;
+  std::vector<Point> hull;
+  for (size_t prev_m = 1, m = kChanFirstGroup; ; prev_m = m, m = (m > n/m) ? n : m*m)
+  {
+    const size_t prev_groups = prev_m == 1 ? n : offsets.size()-1, groups = (n+m-1)/m;
+    auto prev_offset = [&](size_t g) { return prev_m == 1 ? g : offsets[g]; };
+    hulls.resize(work.size()+1);
+    next_offsets.resize(groups+1);
+    size_t k = 0;
+    for (size_t j = 0; j < groups; ++j)
+    {
+      const size_t first = prev_offset(j*m/prev_m);
+      const size_t last = prev_offset(std::min(prev_groups, ((j+1)*m+prev_m-1)/prev_m));
+      next_offsets[j] = k;
+      k += MonotoneChain(work.data()+first, work.data()+last, hulls.data()+k);
+    }
+    next_offsets[groups] = k;
+    hulls.resize(k);
+    work.swap(hulls);
+    offsets.swap(next_offsets);
+
+    auto size_of = [&](size_t g) { return offsets[g+1]-offsets[g]; };
+    size_t g = 0, i = 0;
+    {
+      const size_t at = size_t(std::find(work.begin(), work.end(), start)-work.begin());
+      g = size_t(std::upper_bound(offsets.begin(), offsets.end(), at)-offsets.begin())-1;
+      i = at-offsets[g];
+    }
+
+    hull.clear();
+    for (size_t step = 0; step < m; ++step)
+    {
+      const Point cur = work[offsets[g]+i];
+      hull.emplace_back(cur);
+
+      size_t best_g = g, best_i = (i+1)%size_of(g);
+      for (size_t j = 0; j < groups; ++j)
+      {
+        if (j == g) continue;
+        const size_t c = Tangent(work.data()+offsets[j], size_of(j), cur);
+        if (WrapsTighter(cur, work[offsets[best_g]+best_i], work[offsets[j]+c]))
+        {
+          best_g = j;
+          best_i = c;
+        }
+      }
+
+      const Point next = work[offsets[best_g]+best_i];
+      if (next == start) return hull;
+      g = best_g;
+      i = best_i;
+    }
+    if (m == n) return hull;
+  }
+}
+
+// Work-stealing pool: every worker owns a deque, pops its own tasks LIFO and steals others' FIFO.
+// Tasks submitted from a worker land in that worker's deque, so recursive splits stay local.
+class ThreadPool 
+{
+public:
+  struct Group { std::atomic<size_t> pending{0}; };
+
+  explicit ThreadPool(unsigned int threads) 
+  {
+    threads = std::max(1u, threads);
+    for (unsigned int i = 0; i < threads; ++i) queues_.emplace_back(std::make_unique<Queue>());
+    for (unsigned int i = 0; i < threads; ++i) workers_.emplace_back([this, i] { Work(i); });
+  }
+
+  ~ThreadPool() 
+  {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &worker : workers_) worker.join();
+  }
+
+  unsigned int Size() const { return (unsigned int)(workers_.size()); }
+
+  void Submit(Group &group, std::function<void()> task) 
+  {
+    group.pending.fetch_add(1, std::memory_order_relaxed);
+    const size_t q = (worker_pool_ == this) ? worker_index_ : next_queue_.fetch_add(1)%queues_.size();
+    {
+      std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+      queues_[q]->tasks.emplace_back([&group, task = std::move(task)] {
+        task();
+        group.pending.fetch_sub(1, std::memory_order_release);
+      });
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    wake_.notify_one();
+  }
+
+  // Runs queued tasks on the calling thread until every task of the group has finished.
+  void Wait(Group &group) 
+  {
+    const size_t self = (worker_pool_ == this) ? worker_index_ : 0;
+    while (group.pending.load(std::memory_order_acquire) > 0)
+      if (!RunOne(self)) std::this_thread::yield();
+  }
+
+private:
+  struct Queue 
+  {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  bool RunOne(size_t self) 
+  {
+    std::function<void()> task;
+    for (size_t i = 0; i < queues_.size() && !task; ++i)
+    {
+      Queue &queue = *queues_[(self+i)%queues_.size()];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (queue.tasks.empty()) continue;
+      if (i == 0)
+      {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+      }
+      else
+      {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+      }
+    }
+    if (!task) return false;
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    task();
+    return true;
+  }
+
+  void Work(unsigned int index) 
+  {
+    worker_pool_ = this;
+    worker_index_ = index;
+    while (true)
+    {
+      if (RunOne(index)) continue;
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      wake_.wait(lock, [this] { return stop_ || queued_.load(std::memory_order_acquire) > 0; });
+      if (stop_) return;
+    }
+  }
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+  std::atomic<size_t> queued_{0};
+  std::atomic<size_t> next_queue_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  bool stop_ = false;
+
+  static thread_local ThreadPool *worker_pool_;
+  static thread_local size_t worker_index_;
+};
+
+thread_local ThreadPool *ThreadPool::worker_pool_ = nullptr;
+thread_local size_t ThreadPool::worker_index_ = 0;
+
+ThreadPool &DefaultPool() 
+{
+  static ThreadPool pool(std::thread::hardware_concurrency());
+  return pool;
+}
+
+// Runs body(begin, end) over [0,n) split into roughly `chunks` ranges and waits for all of them.
+template <class F>
+void ParallelFor(ThreadPool &pool, size_t n, size_t chunks, F &&body) 
+{
+  chunks = std::max<size_t>(1, std::min(chunks, n));
+  ThreadPool::Group group;
+  for (size_t c = 0; c < chunks; ++c)
+  {
+    const size_t begin = n*c/chunks, end = n*(c+1)/chunks;
+    pool.Submit(group, [&body, begin, end] { body(begin, end); });
+  }
+  pool.Wait(group);
+}
+
+// Merges two counter-clockwise hulls separated by a vertical line (every point of a left of every point
+// of b) through their upper and lower bridges, O(h1+h2).
+template <class T>
+std::vector<vec2<T>> MergeHulls(const std::vector<vec2<T>> &a, const std::vector<vec2<T>> &b) 
+{
+  if (a.empty()) return b;
+  if (b.empty()) return a;
+  const size_t na = a.size(), nb = b.size();
+  size_t ra = 0, lb = 0;
+  for (size_t i = 1; i < na; ++i)
+    if (a[i].x > a[ra].x || (a[i].x == a[ra].x && a[i].y > a[ra].y)) ra = i;
+  for (size_t i = 1; i < nb; ++i)
+    if (b[i].x < b[lb].x || (b[i].x == b[lb].x && b[i].y < b[lb].y)) lb = i;
+
+  // upper bridge: walk a counter-clockwise and b clockwise while the next vertex lies above
+  size_t ua = ra, ub = lb;
+  for (bool moved = true; moved; )
+  {
+    moved = false;
+    for (size_t nxt = (ua+1)%na; ; nxt = (ua+1)%na)
+    {
+      const int c = Orient(b[ub], a[ua], a[nxt]);
+      if (!(c < 0 || (c == 0 && Farther(b[ub], a[ua], a[nxt])))) break;
+      ua = nxt;
+      moved = true;
+    }
+    for (size_t nxt = (ub+nb-1)%nb; ; nxt = (ub+nb-1)%nb)
+    {
+      const int c = Orient(a[ua], b[ub], b[nxt]);
+      if (!(c > 0 || (c == 0 && Farther(a[ua], b[ub], b[nxt])))) break;
+      ub = nxt;
+      moved = true;
+    }
+  }
+
+  // lower bridge: walk a clockwise and b counter-clockwise while the next vertex lies below
+  size_t la = ra, lo_b = lb;
+  for (bool moved = true; moved; )
+  {
+    moved = false;
+    for (size_t nxt = (la+na-1)%na; ; nxt = (la+na-1)%na)
+    {
+      const int c = Orient(b[lo_b], a[la], a[nxt]);
+      if (!(c > 0 || (c == 0 && Farther(b[lo_b], a[la], a[nxt])))) break;
+      la = nxt;
+      moved = true;
+    }
+    for (size_t nxt = (lo_b+1)%nb; ; nxt = (lo_b+1)%nb)
+    {
+      const int c = Orient(a[la], b[lo_b], b[nxt]);
+      if (!(c < 0 || (c == 0 && Farther(a[la], b[lo_b], b[nxt])))) break;
+      lo_b = nxt;
+      moved = true;
+    }
+  }
+
+  std::vector<vec2<T>> hull;
+  hull.reserve(na+nb);
+  for (size_t i = ua; ; i = (i+1)%na)
+  {
+    hull.emplace_back(a[i]);
+    if (i == la) break;
+  }
+  for (size_t i = lo_b; ; i = (i+1)%nb)
+  {
+    hull.emplace_back(b[i]);
+    if (i == ub) break;
+  }
+  return hull;
+}
+
+// Parallel divide and conquer: points are bucketed into x-slabs at sampled splitters, every slab gets
+// a monotone-chain hull on the pool, and neighbouring slab hulls are bridge-merged pairwise in a tree.
+template <class Points>
+std::vector<PointOf<Points>> DivideAndConquer(const Points &pts, ThreadPool &pool) 
+{
+  using Point = PointOf<Points>;
+  using Coord = decltype(Point::x);
+  const size_t n = pts.size();
+  const size_t slabs = std::min<size_t>(8*pool.Size(), std::max<size_t>(1, n/4096));
+  if (slabs < 2) return MonotoneChain(pts);
+
+  std::vector<Coord> splitters;
+  {
+    std::vector<Coord> sample;
+    const size_t samples = 64*slabs;
+    for (size_t i = 0; i < samples; ++i) sample.emplace_back(pts[i*n/samples].x);
+    std::sort(sample.begin(), sample.end());
+    for (size_t s = 1; s < slabs; ++s) splitters.emplace_back(sample[s*samples/slabs]);
+  }
+  auto slab_of = [&](Coord x) {
+    return size_t(std::upper_bound(splitters.begin(), splitters.end(), x)-splitters.begin());
+  };
+
+  // counting sort of the points into slabs: per-chunk histograms, prefix sums, scatter
+  const size_t chunks = 4*pool.Size();
+  std::vector<size_t> offsets(chunks*slabs, 0);
+  ParallelFor(pool, chunks, chunks, [&](size_t c, size_t) {
+    size_t *count = &offsets[c*slabs];
+    for (size_t i = n*c/chunks; i < n*(c+1)/chunks; ++i) ++count[slab_of(pts[i].x)];
+  });
+  std::vector<size_t> slab_begin(slabs+1, 0);
+  for (size_t s = 0, sum = 0; s < slabs; ++s)
+  {
+    slab_begin[s] = sum;
+    for (size_t c = 0; c < chunks; ++c)
+    {
+      const size_t count = offsets[c*slabs+s];
+      offsets[c*slabs+s] = sum;
+      sum += count;
+    }
+    slab_begin[s+1] = sum;
+  }
+  std::vector<Point> sorted(n);
+  ParallelFor(pool, chunks, chunks, [&](size_t c, size_t) {
+    size_t *offset = &offsets[c*slabs];
+    for (size_t i = n*c/chunks; i < n*(c+1)/chunks; ++i) sorted[offset[slab_of(pts[i].x)]++] = pts[i];
+  });
+
+  std::vector<std::vector<Point>> hulls(slabs);
+  ParallelFor(pool, slabs, slabs, [&](size_t s, size_t) {
+    const size_t count = slab_begin[s+1]-slab_begin[s];
+    hulls[s].resize(count+1);
+    hulls[s].resize(MonotoneChain(&sorted[slab_begin[s]], &sorted[slab_begin[s]]+count, hulls[s].data()));
+  });
+
+  for (size_t stride = 1; stride < slabs; stride *= 2)
+  {
+    const size_t pairs = (slabs+2*stride-1)/(2*stride);
+    ParallelFor(pool, pairs, pairs, [&](size_t p, size_t) {
+      const size_t left = 2*stride*p, right = left+stride;
+      if (right < slabs) hulls[left] = MergeHulls(hulls[left], hulls[right]);
+    });
+  }
+  return hulls[0];
+}
+
+// QuickHull on [first,last), all strictly right of a->b. Partitions the range in place and leaves the
+// hull chain strictly between a and b at its front, ordered from a to b; returns the chain length.
+// The point buffer is the only one the recursion uses; subproblems above kQuickHullCutoff points run as pool
+// tasks, each of which allocates its std::function and queue slot in Submit.
+template <class T>
+size_t QuickHullChain(const vec2<T> &a, const vec2<T> &b, vec2<T> *first, vec2<T> *last, ThreadPool *pool) 
+{
+  if (first == last) return 0;
+
+  // farthest from a->b; of equally far points the one nearest a, or the middle ones would stay collinear
+  vec2<T> *far = first;
+  for (vec2<T> *it = first+1; it != last; ++it)
+  {
+    const int side = Orient(a, b, *far, *it);
+    if (side < 0 || (side == 0 && DotSign(a, b, *far, *it) < 0)) far = it;
+  }
+  std::swap(*first, *far);
+  const vec2<T> c = *first;
+
+  // [c][right of a->c][right of c->b][inside triangle abc]
+  vec2<T> *mid = std::partition(first+1, last, [&](const vec2<T> &p) { return Orient(a, c, p) < 0; });
+  vec2<T> *end = std::partition(mid, last, [&](const vec2<T> &p) { return Orient(c, b, p) < 0; });
+
+  size_t k1 = 0, k2 = 0;
+  if (pool && size_t(end-first) > kQuickHullCutoff)
+  {
+    ThreadPool::Group group;
+    pool->Submit(group, [&] { k1 = QuickHullChain(a, c, first+1, mid, pool); });
+    k2 = QuickHullChain(c, b, mid, end, pool);
+    pool->Wait(group);
+  }
+  else
+  {
+    k1 = QuickHullChain(a, c, first+1, mid, pool);
+    k2 = QuickHullChain(c, b, mid, end, pool);
+  }
+
+  std::rotate(first, first+1, first+1+k1);
+  std::move(mid, mid+k2, first+k1+1);
+  return k1+1+k2;
+}
+
+// QuickHull over a single working copy of pts; pass a null pool to run serially.
+template <class Points>
+std::vector<PointOf<Points>> QuickHull(const Points &pts, ThreadPool *pool) 
+{
+  using Point = PointOf<Points>;
+  if (pts.size() < 3) return MonotoneChain(pts);
+
+  const size_t chunks = pool ? 4*pool->Size() : 1;
+  std::vector<std::pair<Point, Point>> extremes(chunks, {pts[0], pts[0]});
+  auto find_extremes = [&](size_t c, size_t) {
+    Point lo = pts[0], hi = pts[0];
+    for (size_t i = pts.size()*c/chunks; i < pts.size()*(c+1)/chunks; ++i)
+    {
+      const Point &p = pts[i];
+      if (p.x < lo.x || (p.x == lo.x && p.y < lo.y)) lo = p;
+      if (p.x > hi.x || (p.x == hi.x && p.y > hi.y)) hi = p;
+    }
+    extremes[c] = {lo, hi};
+  };
+  if (pool) ParallelFor(*pool, chunks, chunks, find_extremes);
+  else find_extremes(0, 1);
+  Point a = extremes[0].first, b = extremes[0].second;
+  for (const auto &e : extremes)
+  {
+    if (e.first.x < a.x || (e.first.x == a.x && e.first.y < a.y)) a = e.first;
+    if (e.second.x > b.x || (e.second.x == b.x && e.second.y > b.y)) b = e.second;
+  }
+  if (a == b) return {a};
+
+  std::vector<Point> work(pts.begin(), pts.end());
+  Point *lower = work.data();
+  Point *upper = std::partition(lower, lower+work.size(), [&](const Point &p) { return Orient(a, b, p) < 0; });
+  Point *end = std::partition(upper, lower+work.size(), [&](const Point &p) { return Orient(b, a, p) < 0; });
+
+  size_t k1 = 0, k2 = 0;
+  if (pool)
+  {
+    ThreadPool::Group group;
+    pool->Submit(group, [&] { k1 = QuickHullChain(a, b, lower, upper, pool); });
+    k2 = QuickHullChain(b, a, upper, end, pool);
+    pool->Wait(group);
+  }
+  else
+  {
+    k1 = QuickHullChain(a, b, lower, upper, pool);
+    k2 = QuickHullChain(b, a, upper, end, pool);
+  }
+
+  std::vector<Point> hull;
+  hull.reserve(k1+k2+2);
+  hull.emplace_back(a);
+  hull.insert(hull.end(), lower, lower+k1);
+  hull.emplace_back(b);
+  hull.insert(hull.end(), upper, upper+k2);
+  return hull;
+}
+
+const size_t kHullChunk = size_t(1) << 18; // points HullIndices reduces at a time
+
+// Hull of pts as positions in pts, counter-clockwise like MonotoneChain, reading every point once. Chunks
+// of kHullChunk points are copied out, cut down by the Akl-Toussaint octagon and reduced to their own hull
+// on the pool; the hull of those hulls, kept with their positions, is the answer. Memory holds a chunk per
+// thread and the chunk hulls, never all of pts, so a MappedPoints view stays a view: each chunk's pages are
+// released once read and nothing goes back to them. Points with a non-finite coordinate are left out of
+// the copy, counted in skipped if given; the rest keep their positions.
+template <class Points>
+std::vector<size_t> HullIndices(const Points &pts, ThreadPool &pool, size_t *skipped = nullptr) 
+{
+  using Point = PointOf<Points>;
+  using T = decltype(Point::x);
+  using Candidate = std::pair<size_t, Point>;
+  const size_t n = pts.size();
+  const size_t chunks = std::max<size_t>(1, (n+kHullChunk-1)/kHullChunk);
+  std::vector<std::vector<Candidate>> chunk_hulls(chunks);
+  std::vector<size_t> chunk_skipped(chunks, 0);
+  ParallelFor(pool, chunks, chunks, [&](size_t c, size_t) {
+    thread_local PointSet<T> chunk;
+    thread_local std::vector<size_t> positions, order, hull; // positions: where in pts each copied point sits
+    const size_t first = n*c/chunks, last = n*(c+1)/chunks;
+    chunk.clear();
+    chunk.reserve(last-first);
+    positions.clear();
+    for (size_t i = first; i < last; ++i)
+    {
+      const Point pt = pts[i];
+      if constexpr (std::is_floating_point_v<T>)
+        if (!std::isfinite(pt.x) || !std::isfinite(pt.y)) continue;
+      chunk.push_back(pt);
+      positions.emplace_back(i);
+    }
+    chunk_skipped[c] = last-first-positions.size();
+    ReleasePoints(pts, first, last);
+    chunk.track_index();
+    AklToussaint(chunk);
+
+    order.resize(chunk.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    hull.resize(order.size()+1);
+    hull.resize(MonotoneChain(order.data(), order.data()+order.size(), hull.data(), [&](size_t i) { return chunk[i]; }));
+    for (const size_t i : hull) chunk_hulls[c].emplace_back(positions[chunk.index[i]], chunk[i]);
+  });
+  if (skipped) *skipped = std::accumulate(chunk_skipped.begin(), chunk_skipped.end(), size_t(0));
+
+  std::vector<Candidate> candidates;
+  for (const auto &chunk_hull : chunk_hulls) candidates.insert(candidates.end(), chunk_hull.begin(), chunk_hull.end());
+  std::vector<Candidate> hull(candidates.size()+1);
+  hull.resize(MonotoneChain(candidates.data(), candidates.data()+candidates.size(), hull.data(),
+                            [](const Candidate &e) -> const Point & { return e.second; }));
+  std::vector<size_t> indices;
+  for (const auto &e : hull) indices.emplace_back(e.first);
+  return indices;
+}
+
+// Hulls of many small independent groups in one call, the points in CSR layout: group g is
+// pts[offsets[g], offsets[g+1]) and its hull, counter-clockwise like MonotoneChain, comes back as
+// hulls[hull_offsets[g], hull_offsets[g+1]). Tasks take runs of groups holding about as many points each
+// and work in two scratch buffers apiece, dropping a group's points inside its extreme octagon before the
+// sort. Each hull is written where its group's points start and packed down at the end, so no group
+// allocates, and output vectors passed in again keep their storage.
+template <class T>
+void BatchHulls(const vec2<T> *pts, const size_t *offsets, size_t groups, std::vector<vec2<T>> &hulls,
+                std::vector<size_t> &hull_offsets, ThreadPool &pool) 
+{
+  const size_t base = offsets[0], total = offsets[groups]-base;
+  hulls.resize(total);
+  hull_offsets.assign(groups+1, 0);
+  const size_t chunks = std::max<size_t>(1, std::min<size_t>(groups, 8*pool.Size()));
+  auto group_at = [&](size_t c) {
+    return c == chunks ? groups : size_t(std::lower_bound(offsets, offsets+groups, base+total*c/chunks)-offsets);
+  };
+  ParallelFor(pool, chunks, chunks, [&](size_t c, size_t) {
+    std::vector<vec2<T>> work, chain; // capacity carries over from group to group
+    for (size_t g = group_at(c), last = group_at(c+1); g < last; ++g)
+    {
+      work.assign(pts+offsets[g], pts+offsets[g+1]);
+      AklToussaint(work);
+      chain.resize(work.size()+1);
+      const size_t h = MonotoneChain(work.data(), work.data()+work.size(), chain.data());
+      std::copy(chain.data(), chain.data()+h, hulls.data()+(offsets[g]-base));
+      hull_offsets[g+1] = h;
+    }
+  });
+
+  size_t k = 0;
+  for (size_t g = 0; g < groups; ++g)
+  {
+    const size_t from = offsets[g]-base, h = hull_offsets[g+1];
+    if (from != k) std::copy(hulls.begin()+from, hulls.begin()+from+h, hulls.begin()+k);
+    hull_offsets[g+1] = k += h;
+  }
+  hulls.resize(k);
+}
+
+// Online hull: points arrive one at a time and each Insert costs O(log h) amortized. The upper hull is kept
+// as a map from x to y, vertices left to right; the lower hull is the upper hull of the points mirrored in
+// the x axis. An interior point is turned away after one lookup and one orientation per chain.
+template <class T>
+class IncrementalHull 
+{
+public:
+  using Point = vec2<T>;
+
+  // True if pt changed the hull; points inside or on it leave it as it was.
+  bool Insert(const Point &pt) 
+  {
+    const bool upper = upper_.Insert(pt);
+    const bool lower = lower_.Insert(Point{pt.x, -pt.y});
+    return upper || lower;
+  }
+
+  size_t size() const 
+  {
+    if (upper_.Empty()) return 0;
+    size_t n = upper_.Size()+lower_.Size();
+    if (upper_.Front() == Mirror(lower_.Front())) --n;
+    if (upper_.Back() == Mirror(lower_.Back())) --n;
+    return std::max<size_t>(n, 1); // a single point is both ends of both chains
+  }
+
+  // Counter-clockwise from the lowest of the leftmost points, without collinear points, like MonotoneChain.
+  std::vector<Point> Hull() const 
+  {
+    std::vector<Point> hull;
+    hull.reserve(size());
+    for (const auto &v : lower_.Vertices()) hull.emplace_back(Point{v.first, -v.second});
+    for (auto it = upper_.Vertices().rbegin(); it != upper_.Vertices().rend(); ++it)
+      if (hull.back() != Point{it->first, it->second}) hull.emplace_back(Point{it->first, it->second});
+    if (hull.size() > 1 && hull.back() == hull.front()) hull.pop_back();
+    return hull;
+  }
+
+private:
+  static Point Mirror(const Point &pt) { return Point{pt.x, -pt.y}; }
+
+  class Chain 
+  {
+  public:
+    bool Insert(const Point &pt) 
+    {
+      auto next = vertices_.lower_bound(pt.x);
+      if (next != vertices_.end() && next->first == pt.x)
+      {
+        if (pt.y <= next->second) return false;
+        next = vertices_.erase(next);
+      }
+      else if (next != vertices_.end() && next != vertices_.begin() && Orient(At(std::prev(next)), At(next), pt) <= 0)
+        return false;
+
+      // pt is above the chain: drop the neighbours it leaves without a clockwise turn
+      const auto it = vertices_.emplace_hint(next, pt.x, pt.y);
+      while (it != vertices_.begin() && std::prev(it) != vertices_.begin())
+      {
+        const auto prev = std::prev(it);
+        if (Orient(At(std::prev(prev)), At(prev), pt) < 0) break;
+        vertices_.erase(prev);
+      }
+      while (std::next(it) != vertices_.end() && std::next(it, 2) != vertices_.end())
+      {
+        const auto after = std::next(it);
+        if (Orient(pt, At(after), At(std::next(after))) < 0) break;
+        vertices_.erase(after);
+      }
+      return true;
+    }
+
+    bool Empty() const { return vertices_.empty(); }
+    size_t Size() const { return vertices_.size(); }
+    Point Front() const { return At(vertices_.begin()); }
+    Point Back() const { return At(std::prev(vertices_.end())); }
+    const std::map<T, T> &Vertices() const { return vertices_; }
+
+  private:
+    static Point At(typename std::map<T, T>::const_iterator it) { return Point{it->first, it->second}; }
+
+    std::map<T, T> vertices_;
+  };
+
+  Chain upper_, lower_;
+};
+
+// Overmars and van Leeuwen's dynamic hull: insert and erase in O(log^2 n) expected. Points sit in the
+// leaves of a treap ordered by x, then y; each internal node keeps the bridge joining its children's
+// upper hulls and the one joining their lower hulls (taken as upper hulls of the points mirrored in the x
+// axis), so a node's chain is its left child's up to the bridge and its right child's after it. An update
+// recomputes bridges on its way to the root, each in one descent through both children, and stops where
+// the point disappears under a bridge: interior points only touch the bottom of the tree. A node holds its
+// search key and bridge ends by value, so each level of a descent reads one node. Version changes whenever
+// an update reaches the root, which is the only way the hull can change.
+template <class T>
+class HullTreap 
+{
+public:
+  using Point = vec2<T>;
+
+  // Adds a copy of pt; copies of a point are counted, not stored again.
+  void Insert(const Point &pt) 
+  {
+    ++count_;
+    if (root_ == kNil)
+    {
+      root_ = NewNode(pt);
+      ++version_;
+      return;
+    }
+    const uint32_t v = Find(pt);
+    if (nodes_[v].pt == pt)
+    {
+      ++nodes_[v].copies;
+      return;
+    }
+
+    const uint32_t leaf = NewNode(pt), u = NewNode(pt);
+    nodes_[u].priority = uint32_t(rng_());
+    Replace(v, u);
+    if (Less(pt, nodes_[v].pt)) Link(u, leaf, v);
+    else Link(u, v, leaf);
+    while (nodes_[u].parent != kNil && nodes_[u].priority > nodes_[nodes_[u].parent].priority) RotateUp(u);
+    Pull(u);
+
+    // everything up to u is rebuilt; above it a chain needs its bridge again while pt shows on it
+    bool on[2] = {true, true};
+    bool rebuilt = true;
+    for (uint32_t x = leaf; nodes_[x].parent != kNil && (on[0] || on[1]); x = nodes_[x].parent)
+    {
+      const uint32_t w = nodes_[x].parent;
+      if (!rebuilt)
+      {
+        PullBounds(w);
+        for (int c = 0; c < 2; ++c)
+          if (on[c]) Rebridge(w, c);
+      }
+      if (w == u) rebuilt = false;
+      for (int c = 0; c < 2; ++c) on[c] = on[c] && Visible(w, c, nodes_[w].left == x, pt);
+    }
+    if (on[0] || on[1]) ++version_;
+  }
+
+  // Removes a copy of pt; false if there is none.
+  bool Erase(const Point &pt) 
+  {
+    if (root_ == kNil) return false;
+    const uint32_t v = Find(pt);
+    if (nodes_[v].pt != pt) return false;
+    --count_;
+    if (--nodes_[v].copies > 0) return true;
+
+    const uint32_t u = nodes_[v].parent;
+    if (u == kNil)
+    {
+      Free(v);
+      root_ = kNil;
+      ++version_;
+      return true;
+    }
+    // whether pt showed on a chain is read off each bridge before it is recomputed
+    const bool left = nodes_[u].left == v;
+    bool on[2] = {Visible(u, 0, left, pt), Visible(u, 1, left, pt)};
+    const uint32_t sibling = left ? nodes_[u].right : nodes_[u].left;
+    Replace(u, sibling);
+    Free(u);
+    Free(v);
+    for (uint32_t x = sibling; nodes_[x].parent != kNil && (on[0] || on[1]); x = nodes_[x].parent)
+    {
+      const uint32_t w = nodes_[x].parent;
+      PullBounds(w);
+      for (int c = 0; c < 2; ++c)
+      {
+        if (!on[c]) continue;
+        on[c] = Visible(w, c, nodes_[w].left == x, pt);
+        Rebridge(w, c);
+      }
+    }
+    if (on[0] || on[1]) ++version_;
+    return true;
+  }
+
+  size_t size() const { return count_; } // points held, copies included
+  uint64_t Version() const { return version_; }
+
+  // Counter-clockwise from the lowest of the leftmost points, without collinear points, like MonotoneChain.
+  // O(h log(n/h)): the chains are read off the bridges.
+  std::vector<Point> Hull() const 
+  {
+    std::vector<Point> hull, upper;
+    if (root_ == kNil) return hull;
+    uint32_t first = root_;
+    while (!IsLeaf(first)) first = nodes_[first].left;
+    const Point lo = nodes_[first].pt, hi = nodes_[nodes_[root_].hi].pt;
+    Collect(root_, lo, hi, 1, hull);
+    Collect(root_, lo, hi, 0, upper);
+    for (size_t i = upper.size()-1; i-- > 1; ) hull.emplace_back(upper[i]);
+    return hull;
+  }
+
+private:
+  static constexpr uint32_t kNil = ~uint32_t(0);
+
+  struct Node 
+  {
+    Point pt; // a leaf's point; for an internal node the last point of its left subtree, the search key
+    Point ends[2][2]; // [upper, lower] bridge: its end on the left child's chain and on the right child's
+    uint32_t left = kNil, right = kNil, parent = kNil;
+    uint32_t hi = kNil; // last leaf below
+    uint32_t priority = 0; // internal nodes, a max-heap
+    uint32_t copies = 1; // leaves
+  };
+
+  static bool Less(const Point &a, const Point &b) { return a.x < b.x || (a.x == b.x && a.y < b.y); }
+
+  // pt as chain c sees it: as is for the upper chain, mirrored for the lower one.
+  static Point On(const Point &pt, int c) { return c == 0 ? pt : Point{pt.x, -pt.y}; }
+
+  bool IsLeaf(uint32_t v) const { return nodes_[v].left == kNil; }
+
+  uint32_t NewNode(const Point &pt) 
+  {
+    Node node;
+    node.pt = pt;
+    uint32_t v;
+    if (free_.empty())
+    {
+      v = uint32_t(nodes_.size());
+      nodes_.emplace_back(node);
+    }
+    else
+    {
+      v = free_.back();
+      free_.pop_back();
+      nodes_[v] = node;
+    }
+    nodes_[v].hi = v;
+    return v;
+  }
+
+  void Free(uint32_t v) { free_.emplace_back(v); }
+
+  uint32_t Find(const Point &pt) const 
+  {
+    uint32_t v = root_;
+    while (!IsLeaf(v)) v = Less(nodes_[v].pt, pt) ? nodes_[v].right : nodes_[v].left;
+    return v;
+  }
+
+  // Puts node by in old's place under old's parent.
+  void Replace(uint32_t old, uint32_t by) 
+  {
+    const uint32_t parent = nodes_[old].parent;
+    nodes_[by].parent = parent;
+    if (parent == kNil) root_ = by;
+    else if (nodes_[parent].left == old) nodes_[parent].left = by;
+    else nodes_[parent].right = by;
+  }
+
+  void Link(uint32_t v, uint32_t left, uint32_t right) 
+  {
+    nodes_[v].left = left;
+    nodes_[v].right = right;
+    nodes_[left].parent = nodes_[right].parent = v;
+  }
+
+  void PullBounds(uint32_t v) 
+  {
+    nodes_[v].hi = nodes_[nodes_[v].right].hi;
+    nodes_[v].pt = nodes_[nodes_[nodes_[v].left].hi].pt;
+  }
+
+  void Pull(uint32_t v) 
+  {
+    PullBounds(v);
+    Rebridge(v, 0);
+    Rebridge(v, 1);
+  }
+
+  // Turns u and its parent so u takes the parent's place and rebuilds the parent; u is left to the caller.
+  void RotateUp(uint32_t u) 
+  {
+    const uint32_t v = nodes_[u].parent;
+    Replace(v, u);
+    if (nodes_[v].left == u)
+    {
+      Link(v, nodes_[u].right, nodes_[v].right);
+      Link(u, nodes_[u].left, v);
+    }
+    else
+    {
+      Link(v, nodes_[v].left, nodes_[u].left);
+      Link(u, v, nodes_[u].right);
+    }
+    Pull(v);
+  }
+
+  // True if pt, in w's left or right subtree, is on w's chain c.
+  bool Visible(uint32_t w, int c, bool left, const Point &pt) const 
+  {
+    return left ? !Less(nodes_[w].ends[c][0], pt) : !Less(pt, nodes_[w].ends[c][1]);
+  }
+
+  // Bridge of chain c between v's children. With a-b the bridge of the left node and c-d that of the right
+  // one (or the leaf itself), the tangent points p (left) and q (right) are located against them: a point of
+  // the right set on or above line ab puts p at or before a, one of the left set on or above line cd puts q
+  // at or after d. When neither holds, p lies after b or q before c; where lines ab and cd cross relative to
+  // a vertical line between the sets tells which.
+  void Rebridge(uint32_t v, int c) 
+  {
+    const Point sep = On(nodes_[v].pt, c);
+    uint32_t x = nodes_[v].left, y = nodes_[v].right;
+    while (!IsLeaf(x) || !IsLeaf(y))
+    {
+      const Node &nx = nodes_[x], &ny = nodes_[y];
+      const bool x_leaf = nx.left == kNil, y_leaf = ny.left == kNil;
+      const Point a = On(x_leaf ? nx.pt : nx.ends[c][0], c), b = On(x_leaf ? nx.pt : nx.ends[c][1], c);
+      const Point cc = On(y_leaf ? ny.pt : ny.ends[c][0], c), d = On(y_leaf ? ny.pt : ny.ends[c][1], c);
+      if (!x_leaf && Orient(a, b, cc) >= 0) x = nx.left;
+      else if (!y_leaf && Orient(cc, d, b) >= 0) y = ny.right;
+      else if (x_leaf) y = ny.left;
+      else if (y_leaf) x = nx.right;
+      else if (CrossesLeft(a, b, cc, d, sep, nodes_[v].right, c)) x = nx.right;
+      else y = ny.left;
+    }
+    nodes_[v].ends[c][0] = nodes_[x].pt;
+    nodes_[v].ends[c][1] = nodes_[y].pt;
+  }
+
+  // True if line ab meets line cd left of sep, so the left tangent point lies after b. Decided in double
+  // where the error bound allows; otherwise exactly, by whether the point of the right set extreme along
+  // ab's normal stays below line ab.
+  bool CrossesLeft(const Point &a, const Point &b, const Point &c, const Point &d, const Point &sep, uint32_t r,
+                   int chain) const 
+  {
+    if constexpr (!std::is_same_v<T, int64_t>) // differences of 64-bit integers don't survive the double filter
+    {
+      const double abx = double(b.x)-a.x, cdx = double(d.x)-c.x;
+      const double l1 = abx*(double(sep.y)-a.y), r1 = (double(b.y)-a.y)*(double(sep.x)-a.x);
+      const double l2 = cdx*(double(sep.y)-c.y), r2 = (double(d.y)-c.y)*(double(sep.x)-c.x);
+      // (b.x-a.x)(d.x-c.x) times how far line ab runs above line cd at sep.x
+      const double det = abx*(l2-r2)-cdx*(l1-r1);
+      const double bound = 0x1p-46*(std::abs(abx)*(std::abs(l2)+std::abs(r2))+std::abs(cdx)*(std::abs(l1)+std::abs(r1)));
+      if (det > bound) return true;
+      if (det < -bound) return false;
+    }
+    uint32_t y = r;
+    while (!IsLeaf(y))
+      y = Orient(On(nodes_[y].ends[chain][0], chain), On(nodes_[y].ends[chain][1], chain), a, b) > 0 ? nodes_[y].left
+                                                                                                    : nodes_[y].right;
+    return Orient(a, b, On(nodes_[y].pt, chain)) < 0;
+  }
+
+  // Appends v's chain c from point from to point to, both on it, left to right.
+  void Collect(uint32_t v, const Point &from, const Point &to, int c, std::vector<Point> &out) const 
+  {
+    if (IsLeaf(v))
+    {
+      out.emplace_back(nodes_[v].pt);
+      return;
+    }
+    const Point &a = nodes_[v].ends[c][0], &b = nodes_[v].ends[c][1];
+    if (!Less(a, to)) Collect(nodes_[v].left, from, to, c, out);
+    else if (!Less(from, b)) Collect(nodes_[v].right, from, to, c, out);
+    else
+    {
+      Collect(nodes_[v].left, from, a, c, out);
+      Collect(nodes_[v].right, b, to, c, out);
+    }
+  }
+
+  std::vector<Node> nodes_;
+  std::vector<uint32_t> free_;
+  uint32_t root_ = kNil;
+  size_t count_ = 0;
+  uint64_t version_ = 0;
+  std::mt19937 rng_{0x9e3779b9u};
+};
+
+// Fully dynamic hull for update-heavy workloads. Points are kept in buckets of up to 2*kBucket points over
+// consecutive ranges of x, then y, each with the hull of its points; only those hulls' vertices go into a
+// HullTreap, whose hull is the answer. A point that lands inside its bucket's hull costs a lookup among the
+// buckets' bounds and an O(log kBucket) test, and leaving costs a scan of the bucket; only a bucket hull that
+// changes rebuilds in O(kBucket log kBucket) and updates the treap with its changed vertices, which is small
+// enough to stay in cache. Hull() hands out a copy of the treap's hull, re-read only after it changed.
+template <class T>
+class DynamicHull 
+{
+public:
+  using Point = vec2<T>;
+  static constexpr size_t kBucket = 256;
+
+  // Adds a copy of pt.
+  void Insert(const Point &pt) 
+  {
+    ++count_;
+    if (buckets_.empty())
+    {
+      buckets_.emplace_back();
+      lows_.emplace_back(pt);
+    }
+    const size_t b = BucketOf(pt);
+    Bucket &bucket = buckets_[b];
+    bucket.pts.emplace_back(pt);
+    if (!InsideHull(bucket.hull, pt)) Cover(b, pt);
+    if (bucket.pts.size() > 2*kBucket) Split(b);
+  }
+
+  // Removes a copy of pt; false if there is none.
+  bool Erase(const Point &pt) 
+  {
+    if (buckets_.empty()) return false;
+    const size_t b = BucketOf(pt);
+    Bucket &bucket = buckets_[b];
+    const auto it = std::find(bucket.pts.begin(), bucket.pts.end(), pt);
+    if (it == bucket.pts.end()) return false;
+    --count_;
+    *it = bucket.pts.back();
+    bucket.pts.pop_back();
+    if (!InsideHull(bucket.hull, pt)) Uncover(b, pt);
+    if (bucket.pts.size() < kBucket/4) Shrink(b);
+    return true;
+  }
+
+  size_t size() const { return count_; } // points held, copies included
+
+  // Counter-clockwise from the lowest of the leftmost points, without collinear points, like MonotoneChain.
+  // O(h) while the hull is as it was at the last call, O(h log(m/h)) over the m bucket hull vertices after
+  // it changed.
+  std::vector<Point> Hull() const 
+  {
+    if (hull_version_ != tree_.Version())
+    {
+      hull_ = tree_.Hull();
+      hull_version_ = tree_.Version();
+    }
+    return hull_;
+  }
+
+private:
+  struct Bucket 
+  {
+    std::vector<Point> pts;
+    std::vector<Point> hull; // counter-clockwise like MonotoneChain, its vertices in tree_
+  };
+
+  static bool Less(const Point &a, const Point &b) { return a.x < b.x || (a.x == b.x && a.y < b.y); }
+
+  // Bucket b holds the points from lows_[b] up to lows_[b+1]; the first bucket's range is open below.
+  size_t BucketOf(const Point &pt) const 
+  {
+    return size_t(std::upper_bound(lows_.begin()+1, lows_.end(), pt, Less)-lows_.begin())-1;
+  }
+
+  // Makes the hull of scratch_, which may be reordered, bucket b's hull.
+  void Rehull(size_t b) 
+  {
+    fresh_.resize(scratch_.size()+1);
+    fresh_.resize(MonotoneChain(scratch_.data(), scratch_.data()+scratch_.size(), fresh_.data()));
+    Adopt(b);
+  }
+
+  // Rehulls bucket b after pt, outside or on its hull, joined it. The hull's lower chain and its upper chain
+  // reversed are both sorted, so merged with pt they feed the chain scan in O(h) without a sort.
+  void Cover(size_t b, const Point &pt) 
+  {
+    SortedVertices(buckets_[b].hull, sorted_);
+    const auto at = std::lower_bound(sorted_.begin(), sorted_.end(), pt, Less);
+    if (at == sorted_.end() || *at != pt) sorted_.insert(at, pt);
+    fresh_.resize(sorted_.size()+1);
+    fresh_.resize(MonotoneChainSorted(sorted_.data(), sorted_.data()+sorted_.size(), fresh_.data(),
+                                      [](const Point &p) -> const Point & { return p; }));
+    Adopt(b);
+  }
+
+  // Vertices of a hull like MonotoneChain's sorted by x, then y, in O(h): its lower chain merged with its
+  // upper chain reversed.
+  static void SortedVertices(const std::vector<Point> &hull, std::vector<Point> &out) 
+  {
+    out.clear();
+    if (hull.empty()) return;
+    size_t r = 0; // the last vertex of the lower chain
+    for (size_t i = 1; i < hull.size(); ++i)
+      if (Less(hull[r], hull[i])) r = i;
+    std::merge(hull.begin(), hull.begin()+r+1, hull.rbegin(), hull.rend()-(r+1), std::back_inserter(out), Less);
+  }
+
+  // Makes fresh_ bucket b's hull and gives the treap the vertices it gained and lost.
+  void Adopt(size_t b) 
+  {
+    std::vector<Point> &old = buckets_[b].hull;
+    if (fresh_ == old) return;
+    std::vector<Point> &gone = scratch_, &added = sorted_;
+    SortedVertices(old, gone);
+    SortedVertices(fresh_, added);
+    for (size_t i = 0, j = 0; i < gone.size() || j < added.size(); )
+    {
+      if (j == added.size() || (i < gone.size() && Less(gone[i], added[j]))) tree_.Erase(gone[i++]);
+      else if (i == gone.size() || Less(added[j], gone[i])) tree_.Insert(added[j++]);
+      else
+      {
+        ++i;
+        ++j;
+      }
+    }
+    old.swap(fresh_);
+  }
+
+  // Rehulls bucket b after pt, on its hull's boundary, left it. Only points beyond the chord between a
+  // vertex's neighbors can take its place, so one orientation per point picks the few that join the
+  // remaining vertices; a point on an edge leaves the hull as it was.
+  void Uncover(size_t b, const Point &pt) 
+  {
+    const Bucket &bucket = buckets_[b];
+    const std::vector<Point> &hull = bucket.hull;
+    const size_t h = hull.size(), at = size_t(std::find(hull.begin(), hull.end(), pt)-hull.begin());
+    if (h >= 3 && at == h) return;
+    scratch_.clear();
+    if (h < 3) scratch_.assign(bucket.pts.begin(), bucket.pts.end());
+    else
+    {
+      const Point prev = hull[(at+h-1)%h], next = hull[(at+1)%h];
+      for (size_t i = 0; i < h; ++i)
+        if (i != at) scratch_.emplace_back(hull[i]);
+      for (const auto &p : bucket.pts)
+        if (Orient(prev, next, p) < 0) scratch_.emplace_back(p);
+    }
+    Rehull(b);
+  }
+
+  // Splits bucket b at its median point; points equal to it all go right so a point has one bucket.
+  void Split(size_t b) 
+  {
+    std::vector<Point> &pts = buckets_[b].pts;
+    std::nth_element(pts.begin(), pts.begin()+pts.size()/2, pts.end(), Less);
+    const Point mid = pts[pts.size()/2];
+    const auto cut = std::partition(pts.begin(), pts.end(), [&](const Point &p) { return Less(p, mid); });
+    if (cut == pts.begin()) return; // all copies of one point
+    Bucket right;
+    right.pts.assign(cut, pts.end());
+    pts.erase(cut, pts.end());
+    buckets_.insert(buckets_.begin()+b+1, std::move(right));
+    lows_.insert(lows_.begin()+b+1, mid);
+    scratch_.assign(buckets_[b].pts.begin(), buckets_[b].pts.end());
+    Rehull(b);
+    scratch_.assign(buckets_[b+1].pts.begin(), buckets_[b+1].pts.end());
+    Rehull(b+1);
+  }
+
+  // Folds the small bucket b into a neighbor when both fit in one, dropping it outright once empty.
+  void Shrink(size_t b) 
+  {
+    if (buckets_.size() == 1) return;
+    const size_t into = b == 0 || (b+1 < buckets_.size() && buckets_[b+1].pts.size() < buckets_[b-1].pts.size()) ? b+1 : b-1;
+    if (buckets_[into].pts.size()+buckets_[b].pts.size() > 2*kBucket) return;
+    std::vector<Point> &pts = buckets_[into].pts;
+    pts.insert(pts.end(), buckets_[b].pts.begin(), buckets_[b].pts.end());
+    scratch_.clear(); // b's hull leaves the treap
+    Rehull(b);
+    scratch_.assign(pts.begin(), pts.end());
+    Rehull(into);
+    buckets_.erase(buckets_.begin()+b);
+    lows_.erase(lows_.begin()+std::max<size_t>(b, into)); // the right one's bound goes
+  }
+
+  std::vector<Bucket> buckets_;
+  std::vector<Point> lows_;
+  HullTreap<T> tree_;
+  std::vector<Point> scratch_, fresh_, sorted_;
+  size_t count_ = 0;
+  mutable std::vector<Point> hull_;
+  mutable uint64_t hull_version_ = 0;
+};
+
+// Hull of a sliding window over a stream: points arrive at the back with a time stamp and expire from the
+// front, one at a time or by age. The window is a queue of blocks of kBlock points run as two stacks. Blocks
+// that fill up are folded into a single back hull; when the front runs dry the blocks behind it move over
+// in one pass, newest first, each keeping the hull of itself and every newer front block. Either end costs
+// O(log kBlock + h/kBlock) amortized per point, and Hull merges two hulls with the points left in the two
+// partial blocks, so neither depends on the window's length.
+template <class T>
+class SlidingWindowHull 
+{
+public:
+  using Point = vec2<T>;
+  static constexpr size_t kBlock = 256;
+
+  void Push(const Point &pt, double time = 0.0) 
+  {
+    if (blocks_.empty() || blocks_.back().pts.size() == kBlock)
+    {
+      blocks_.emplace_back();
+      blocks_.back().pts.reserve(kBlock);
+      blocks_.back().times.reserve(kBlock);
+    }
+    Block &block = blocks_.back();
+    block.pts.emplace_back(pt);
+    block.times.emplace_back(time);
+    ++count_;
+    if (block.pts.size() == kBlock) back_ = Merge(block, back_);
+  }
+
+  // Expires the oldest point.
+  void Pop() 
+  {
+    if (count_ == 0) return;
+    if (front_ == 0 && blocks_.front().pts.size() == kBlock) Flip();
+    Block &oldest = blocks_.front();
+    --count_;
+    if (++oldest.offset < oldest.pts.size()) return;
+    blocks_.pop_front();
+    if (front_ > 0) --front_;
+  }
+
+  // Expires every point stamped before time.
+  void ExpireBefore(double time) 
+  {
+    while (count_ > 0 && blocks_.front().times[blocks_.front().offset] < time) Pop();
+  }
+
+  size_t size() const { return count_; }
+
+  // Counter-clockwise from the lowest of the leftmost points, without collinear points, like MonotoneChain.
+  std::vector<Point> Hull() const 
+  {
+    std::vector<Point> work(back_);
+    if (front_ > 0)
+    {
+      const Block &oldest = blocks_.front();
+      work.insert(work.end(), oldest.pts.begin()+oldest.offset, oldest.pts.end());
+      if (front_ > 1) work.insert(work.end(), blocks_[1].suffix.begin(), blocks_[1].suffix.end());
+    }
+    if (!blocks_.empty() && blocks_.back().pts.size() < kBlock)
+    {
+      const Block &newest = blocks_.back();
+      work.insert(work.end(), newest.pts.begin()+newest.offset, newest.pts.end());
+    }
+    std::vector<Point> hull(work.size()+1);
+    hull.resize(MonotoneChain(work.data(), work.data()+work.size(), hull.data()));
+    return hull;
+  }
+
+private:
+  struct Block 
+  {
+    std::vector<Point> pts;
+    std::vector<double> times;
+    std::vector<Point> suffix; // hull of this block's points and every newer front block's, front blocks only
+    size_t offset = 0; // points already expired
+  };
+
+  // Hull of block's live points and hull.
+  static std::vector<Point> Merge(const Block &block, const std::vector<Point> &hull) 
+  {
+    std::vector<Point> work(block.pts.begin()+block.offset, block.pts.end());
+    work.insert(work.end(), hull.begin(), hull.end());
+    std::vector<Point> merged(work.size()+1);
+    merged.resize(MonotoneChain(work.data(), work.data()+work.size(), merged.data()));
+    return merged;
+  }
+
+  // Moves every full block to the front stack.
+  void Flip() 
+  {
+    const size_t full = blocks_.size()-(blocks_.back().pts.size() < kBlock);
+    static const std::vector<Point> none;
+    for (size_t i = full; i-- > 0;) blocks_[i].suffix = Merge(blocks_[i], i+1 < full ? blocks_[i+1].suffix : none);
+    front_ = full;
+    back_.clear();
+  }
+
+  std::deque<Block> blocks_;
+  size_t front_ = 0; // blocks on the front stack, the oldest ones
+  std::vector<Point> back_; // hull of the full blocks behind the front stack
+  size_t count_ = 0;
+};
+
+// Exact ordering behind the wrapping step: true if p turns less than q, seen from cur, away from the
+// direction from->cur. Counter-clockwise turns of 0..180 degrees rank first, smallest first, then
+// clockwise ones, smallest first; of two points in the same direction the farther one wins.
+template <class T>
+bool TurnsBefore(const vec2<T> &from, const vec2<T> &cur, const vec2<T> &p, const vec2<T> &q) 
+{
+  const bool p_cw = Orient(from, cur, cur, p) < 0;
+  const bool q_cw = Orient(from, cur, cur, q) < 0;
+  if (p_cw != q_cw) return q_cw;
+  if (const int turn = Orient(cur, p, q)) return p_cw ? turn < 0 : turn > 0;
+  if (DotSign(cur, p, cur, q) < 0) return DotSign(from, cur, cur, p) > 0; // 0 and 180 degrees
+  return Farther(cur, q, p);
+}
+
+// Scalar wrapping step over [0,n): index of the first point in TurnsBefore order, n if every point is cur.
+size_t WrapCandidateScalar(const float *xs, const float *ys, size_t n, const vec2f &cur, const vec2f &from) 
+{
+  size_t closest = n;
+  bool closest_cw = false;
+  for (size_t idx = 0; idx < n; ++idx)
+  {
+    const vec2f p = {xs[idx], ys[idx]};
+    if (p == cur) continue;
+    const bool cw = Orient(from, cur, cur, p) < 0;
+    if (closest != n)
+    {
+      const vec2f q = {xs[closest], ys[closest]};
+      if (cw != closest_cw)
+      {
+        if (cw) continue;
+      }
+      else if (const int turn = Orient(cur, p, q))
+      {
+        if (cw ? turn > 0 : turn < 0) continue;
+      }
+      else if (!TurnsBefore(from, cur, p, q)) continue;
+    }
+    closest = idx;
+    closest_cw = cw;
+  }
+  return closest;
+}
+
+// orient2d error bound for float evaluation; below kFloatTiny products may be subnormal and it no longer holds
+const float kFloatErrBound = (3.0f+16.0f*0x1p-24f)*0x1p-24f;
+const float kFloatTiny = 1e-30f;
+
+// Folds lane winners of a vectorized scan and the scalar tail [tail,n) into one index (n if none).
+size_t FoldCandidates(const float *xs, const float *ys, size_t n, const int32_t *lane_idx, const int32_t *lane_set,
+                      unsigned int lanes, size_t tail, const vec2f &cur, const vec2f &from) 
+{
+  size_t best = n;
+  auto offer = [&](size_t k) {
+    const vec2f p = {xs[k], ys[k]};
+    if (p == cur) return;
+    if (best == n || TurnsBefore(from, cur, p, vec2f{xs[best], ys[best]})) best = k;
+  };
+  for (unsigned int j = 0; j < lanes; ++j)
+    if (lane_set[j]) offer(size_t(lane_idx[j]));
+  for (size_t k = tail; k < n; ++k) offer(k);
+  return best;
+}
+
+#ifdef HULL_X86
+// AVX2 wrapping step: eight lanes each keep their own best candidate, compared in float against the
+// orient2d bound. Lanes the filter cannot decide are settled with the exact predicates.
+HULL_TARGET("avx2")
+size_t WrapCandidateAvx2(const float *xs, const float *ys, size_t n, const vec2f &cur, const vec2f &from) 
+{
+  const __m256 cx = _mm256_set1_ps(cur.x), cy = _mm256_set1_ps(cur.y);
+  const __m256 rx = _mm256_set1_ps(cur.x-from.x), ry = _mm256_set1_ps(cur.y-from.y);
+  const __m256 err = _mm256_set1_ps(kFloatErrBound), tiny = _mm256_set1_ps(kFloatTiny);
+  const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  const __m256 ones = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256i step = _mm256_set1_epi32(8);
+  __m256 best_dx = zero, best_dy = zero, best_cw = zero, has_best = zero;
+  __m256i best_idx = _mm256_setzero_si256();
+  __m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  alignas(32) float lane_dx[8], lane_dy[8];
+  alignas(32) int32_t lane_idx[8], lane_cw[8], lane_set[8];
+
+  size_t i = 0;
+  for (; i+8 <= n; i += 8, idx = _mm256_add_epi32(idx, step))
+  {
+    const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs+i), cx);
+    const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys+i), cy);
+
+    const __m256 side_l = _mm256_mul_ps(rx, dy), side_r = _mm256_mul_ps(ry, dx);
+    const __m256 side = _mm256_sub_ps(side_l, side_r);
+    const __m256 side_bound = _mm256_max_ps(tiny,
+        _mm256_mul_ps(err, _mm256_add_ps(_mm256_and_ps(side_l, abs_mask), _mm256_and_ps(side_r, abs_mask))));
+    const __m256 turn_l = _mm256_mul_ps(dx, best_dy), turn_r = _mm256_mul_ps(dy, best_dx);
+    const __m256 turn = _mm256_sub_ps(turn_l, turn_r);
+    const __m256 turn_bound = _mm256_max_ps(tiny,
+        _mm256_mul_ps(err, _mm256_add_ps(_mm256_and_ps(turn_l, abs_mask), _mm256_and_ps(turn_r, abs_mask))));
+
+    const __m256 cw = _mm256_cmp_ps(side, zero, _CMP_LT_OQ);
+    const __m256 turn_pos = _mm256_cmp_ps(turn, zero, _CMP_GT_OQ);
+    const __m256 same = _mm256_xor_ps(_mm256_xor_ps(cw, best_cw), ones);
+    const __m256 skip = _mm256_and_ps(_mm256_cmp_ps(dx, zero, _CMP_EQ_OQ), _mm256_cmp_ps(dy, zero, _CMP_EQ_OQ));
+    const __m256 side_unsure = _mm256_cmp_ps(_mm256_and_ps(side, abs_mask), side_bound, _CMP_NGT_UQ);
+    const __m256 turn_unsure = _mm256_cmp_ps(_mm256_and_ps(turn, abs_mask), turn_bound, _CMP_NGT_UQ);
+    const __m256 unsure = _mm256_andnot_ps(skip,
+        _mm256_or_ps(side_unsure, _mm256_and_ps(has_best, _mm256_and_ps(same, turn_unsure))));
+
+    // same side: the smaller turn wins; different sides: the counter-clockwise one wins
+    __m256 wins = _mm256_or_ps(_mm256_and_ps(same, _mm256_xor_ps(turn_pos, cw)), _mm256_andnot_ps(same, _mm256_andnot_ps(cw, ones)));
+    wins = _mm256_andnot_ps(_mm256_or_ps(skip, unsure), _mm256_or_ps(wins, _mm256_andnot_ps(has_best, ones)));
+
+    best_dx = _mm256_blendv_ps(best_dx, dx, wins);
+    best_dy = _mm256_blendv_ps(best_dy, dy, wins);
+    best_cw = _mm256_blendv_ps(best_cw, cw, wins);
+    best_idx = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(best_idx), _mm256_castsi256_ps(idx), wins));
+    has_best = _mm256_or_ps(has_best, wins);
+
+    if (int mask = _mm256_movemask_ps(unsure))
+    {
+      _mm256_store_ps(lane_dx, best_dx);
+      _mm256_store_ps(lane_dy, best_dy);
+      _mm256_store_si256((__m256i *)lane_idx, best_idx);
+      _mm256_store_si256((__m256i *)lane_cw, _mm256_castps_si256(best_cw));
+      _mm256_store_si256((__m256i *)lane_set, _mm256_castps_si256(has_best));
+      for (unsigned int j = 0; mask; ++j, mask >>= 1)
+      {
+        if (!(mask & 1)) continue;
+        const vec2f p = {xs[i+j], ys[i+j]};
+        if (lane_set[j] && !TurnsBefore(from, cur, p, vec2f{xs[lane_idx[j]], ys[lane_idx[j]]})) continue;
+        lane_dx[j] = p.x-cur.x;
+        lane_dy[j] = p.y-cur.y;
+        lane_idx[j] = int32_t(i+j);
+        lane_cw[j] = Orient(from, cur, cur, p) < 0 ? -1 : 0;
+        lane_set[j] = -1;
+      }
+      best_dx = _mm256_load_ps(lane_dx);
+      best_dy = _mm256_load_ps(lane_dy);
+      best_idx = _mm256_load_si256((const __m256i *)lane_idx);
+      best_cw = _mm256_castsi256_ps(_mm256_load_si256((const __m256i *)lane_cw));
+      has_best = _mm256_castsi256_ps(_mm256_load_si256((const __m256i *)lane_set));
+    }
+  }
+
+  _mm256_store_si256((__m256i *)lane_idx, best_idx);
+  _mm256_store_si256((__m256i *)lane_set, _mm256_castps_si256(has_best));
+  return FoldCandidates(xs, ys, n, lane_idx, lane_set, 8, i, cur, from);
+}
+
+// AVX-512 version of WrapCandidateAvx2 with sixteen lanes and mask registers.
+HULL_TARGET("avx512f")
+size_t WrapCandidateAvx512(const float *xs, const float *ys, size_t n, const vec2f &cur, const vec2f &from) 
+{
+  const __m512 cx = _mm512_set1_ps(cur.x), cy = _mm512_set1_ps(cur.y);
+  const __m512 rx = _mm512_set1_ps(cur.x-from.x), ry = _mm512_set1_ps(cur.y-from.y);
+  const __m512 err = _mm512_set1_ps(kFloatErrBound), tiny = _mm512_set1_ps(kFloatTiny);
+  const __m512 zero = _mm512_setzero_ps();
+  const __m512i step = _mm512_set1_epi32(16);
+  __m512 best_dx = zero, best_dy = zero;
+  __m512i best_idx = _mm512_setzero_si512();
+  __m512i idx = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  __mmask16 best_cw = 0, has_best = 0;
+  alignas(64) float lane_dx[16], lane_dy[16];
+  alignas(64) int32_t lane_idx[16], lane_set[16];
+
+  size_t i = 0;
+  for (; i+16 <= n; i += 16, idx = _mm512_add_epi32(idx, step))
+  {
+    const __m512 dx = _mm512_sub_ps(_mm512_loadu_ps(xs+i), cx);
+    const __m512 dy = _mm512_sub_ps(_mm512_loadu_ps(ys+i), cy);
+
+    const __m512 side_l = _mm512_mul_ps(rx, dy), side_r = _mm512_mul_ps(ry, dx);
+    const __m512 side = _mm512_sub_ps(side_l, side_r);
+    // maskz_max with a full mask is max; plain _mm512_max_ps trips -Wmaybe-uninitialized in GCC 12 headers
+    const __m512 side_bound = _mm512_maskz_max_ps(0xFFFF, tiny, _mm512_mul_ps(err, _mm512_add_ps(_mm512_abs_ps(side_l), _mm512_abs_ps(side_r))));
+    const __m512 turn_l = _mm512_mul_ps(dx, best_dy), turn_r = _mm512_mul_ps(dy, best_dx);
+    const __m512 turn = _mm512_sub_ps(turn_l, turn_r);
+    const __m512 turn_bound = _mm512_maskz_max_ps(0xFFFF, tiny, _mm512_mul_ps(err, _mm512_add_ps(_mm512_abs_ps(turn_l), _mm512_abs_ps(turn_r))));
+
+    const __mmask16 cw = _mm512_cmp_ps_mask(side, zero, _CMP_LT_OQ);
+    const __mmask16 turn_pos = _mm512_cmp_ps_mask(turn, zero, _CMP_GT_OQ);
+    const __mmask16 same = __mmask16(~(cw ^ best_cw));
+    const __mmask16 skip = _mm512_cmp_ps_mask(dx, zero, _CMP_EQ_OQ) & _mm512_cmp_ps_mask(dy, zero, _CMP_EQ_OQ);
+    const __mmask16 side_unsure = _mm512_cmp_ps_mask(_mm512_abs_ps(side), side_bound, _CMP_NGT_UQ);
+    const __mmask16 turn_unsure = _mm512_cmp_ps_mask(_mm512_abs_ps(turn), turn_bound, _CMP_NGT_UQ);
+    const __mmask16 unsure = __mmask16(~skip & (side_unsure | (has_best & same & turn_unsure)));
+    const __mmask16 wins = __mmask16(~(skip | unsure) & (((same & (turn_pos ^ cw)) | (~same & ~cw)) | ~has_best));
+
+    best_dx = _mm512_mask_blend_ps(wins, best_dx, dx);
+    best_dy = _mm512_mask_blend_ps(wins, best_dy, dy);
+    best_idx = _mm512_mask_blend_epi32(wins, best_idx, idx);
+    best_cw = __mmask16((best_cw & ~wins) | (cw & wins));
+    has_best = __mmask16(has_best | wins);
+
+    if (unsure)
+    {
+      _mm512_store_ps(lane_dx, best_dx);
+      _mm512_store_ps(lane_dy, best_dy);
+      _mm512_store_si512(lane_idx, best_idx);
+      for (unsigned int j = 0; j < 16; ++j)
+      {
+        const __mmask16 bit = __mmask16(1u << j);
+        if (!(unsure & bit)) continue;
+        const vec2f p = {xs[i+j], ys[i+j]};
+        if ((has_best & bit) && !TurnsBefore(from, cur, p, vec2f{xs[lane_idx[j]], ys[lane_idx[j]]})) continue;
+        lane_dx[j] = p.x-cur.x;
+        lane_dy[j] = p.y-cur.y;
+        lane_idx[j] = int32_t(i+j);
+        best_cw = __mmask16(Orient(from, cur, cur, p) < 0 ? (best_cw | bit) : (best_cw & ~bit));
+        has_best = __mmask16(has_best | bit);
+      }
+      best_dx = _mm512_load_ps(lane_dx);
+      best_dy = _mm512_load_ps(lane_dy);
+      best_idx = _mm512_load_si512(lane_idx);
+    }
+  }
+
+  _mm512_store_si512(lane_idx, best_idx);
+  for (unsigned int j = 0; j < 16; ++j) lane_set[j] = (has_best >> j) & 1;
+  return FoldCandidates(xs, ys, n, lane_idx, lane_set, 16, i, cur, from);
+}
+#endif
+
+enum class SimdLevel { kScalar, kAvx2, kAvx512 };
+
+SimdLevel DetectSimd() 
+{
+#if defined(HULL_X86) && defined(__GNUC__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) return SimdLevel::kAvx512;
+  if (__builtin_cpu_supports("avx2")) return SimdLevel::kAvx2;
+#elif defined(HULL_X86) && defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  if (!(info[2] & (1 << 27))) return SimdLevel::kScalar; // no OSXSAVE
+  const unsigned long long xcr0 = _xgetbv(0);
+  __cpuidex(info, 7, 0);
+  if ((info[1] & (1 << 16)) && (xcr0 & 0xe6) == 0xe6) return SimdLevel::kAvx512;
+  if ((info[1] & (1 << 5)) && (xcr0 & 0x6) == 0x6) return SimdLevel::kAvx2;
+#endif
+  return SimdLevel::kScalar;
+}
+
+const SimdLevel kSimd = DetectSimd();
+
+// Wrapping step of SolverStep over the SoA points: index of the first point in TurnsBefore order, 0 if
+// every point is cur. Picks the widest kernel the host supports.
+size_t WrapCandidate(const float *xs, const float *ys, size_t n, const vec2f &cur, const vec2f &from, SimdLevel simd = kSimd) 
+{
+  size_t closest = n;
+#ifdef HULL_X86
+  if (n > size_t(INT32_MAX)) simd = SimdLevel::kScalar; // lanes track 32-bit indices
+  if (simd == SimdLevel::kAvx512) closest = WrapCandidateAvx512(xs, ys, n, cur, from);
+  else if (simd == SimdLevel::kAvx2) closest = WrapCandidateAvx2(xs, ys, n, cur, from);
+  else
+#endif
+  closest = WrapCandidateScalar(xs, ys, n, cur, from);
+  return closest == n ? 0 : closest;
+}
+
+// Overlay geometry in equal-sized records of a ring and a line: the header holds the center's ring and the
+// last line, from the center to the newest segment; record i+1 holds segment i's ring and its line back to
+// segment i-1 (collapsed for the first). A new segment only appends a record and rewrites the last line.
+// Every vertex carries its color: the header and the newest segment's ring in kLastColor, the rest kHullColor.
+const size_t kOverlayRecord = kRingVertices+kLineVertices;
+
+void BuildOverlay(const std::vector<vec2f> &segments, const vec2f &center, std::vector<float> &container,
+                  std::vector<uint32_t> &colors) 
+{
+  container.resize(2*kOverlayRecord*(segments.size()+1));
+  DrawPoint(center, &container[0]);
+  DrawLine(center, segments.empty() ? center : segments.back(), &container[2*kRingVertices]);
+  colors.assign(kOverlayRecord, kLastColor);
+  for (size_t i = 0; i < segments.size(); ++i)
+  {
+    float *record = &container[2*kOverlayRecord*(i+1)];
+    DrawPoint(segments[i], record);
+    DrawLine(segments[i], segments[i ? i-1 : 0], record+2*kRingVertices);
+    colors.insert(colors.end(), kRingVertices, i+1 == segments.size() ? kLastColor : kHullColor);
+    colors.insert(colors.end(), kLineVertices, kHullColor);
+  }
+}
+
+// Overlay vertices kept in step with the hull segments, on the CPU for the software rasterizer and in a
+// GL buffer. When the segments grow by one at the end only the new record and the last line are generated
+// and sent with glBufferSubData, along with the colors from the previous newest ring on; the buffers grow by
+// doubling. Anything else, like SolverStep erasing the prefix of line_segments, rebuilds everything.
+class OverlayBuffer 
+{
+public:
+  // Points vao's attribute 0 at the buffer vbo and attribute 2 at color_vbo, which this object fills from then on.
+  void Attach(unsigned int vao, unsigned int vbo, unsigned int color_vbo) 
+  {
+    vbo_ = vbo;
+    color_vbo_ = color_vbo;
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2*sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, color_vbo);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(uint32_t), (void*)0);
+    glEnableVertexAttribArray(2);
+    glBindBuffer(GL_ARRAY_BUFFER, 0); 
+    glBindVertexArray(0); 
+  }
+
+  const std::vector<float> &Vertices() const { return vertices_; }
+  const std::vector<uint32_t> &Colors() const { return colors_; }
+  size_t UploadedBytes() const { return uploaded_bytes_; }
+
+  void Update(const std::vector<vec2f> &segments, const vec2f &center) 
+  {
+    const size_t n = drawn_.size();
+    if (n == 0 || center != center_ || segments.size() != n+1 || !std::equal(drawn_.begin(), drawn_.end(), segments.begin()))
+    {
+      BuildOverlay(segments, center, vertices_, colors_);
+      drawn_ = segments;
+      center_ = center;
+      Upload(vbo_, vertices_, vertex_capacity_, 0, vertices_.size());
+      Upload(color_vbo_, colors_, color_capacity_, 0, colors_.size());
+      return;
+    }
+
+    const size_t appended = vertices_.size();
+    DrawPoint(segments[n], vertices_);
+    DrawLine(segments[n], segments[n-1], vertices_);
+    DrawLine(center, segments[n], &vertices_[2*kRingVertices]);
+    drawn_.emplace_back(segments[n]);
+    Upload(vbo_, vertices_, vertex_capacity_, appended, vertices_.size()-appended);
+    Upload(vbo_, vertices_, vertex_capacity_, 2*kRingVertices, 2*kLineVertices);
+
+    // the previous newest ring turns kHullColor
+    const size_t recolored = n*kOverlayRecord;
+    std::fill(colors_.begin()+recolored, colors_.begin()+recolored+kRingVertices, kHullColor);
+    colors_.insert(colors_.end(), kRingVertices, kLastColor);
+    colors_.insert(colors_.end(), kLineVertices, kHullColor);
+    Upload(color_vbo_, colors_, color_capacity_, recolored, colors_.size()-recolored);
+  }
+
+private:
+  // elements [first, first+count) of data to the GL buffer vbo, which holds capacity elements
+  template <class T>
+  void Upload(unsigned int vbo, const std::vector<T> &data, size_t &capacity, size_t first, size_t count) 
+  {
+    uploaded_bytes_ += count*sizeof(T);
+    if (headless) return;
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    if (data.size() > capacity)
+    {
+      capacity = std::max(2*capacity, data.size());
+      glBufferData(GL_ARRAY_BUFFER, capacity*sizeof(T), NULL, GL_DYNAMIC_DRAW);
+      first = 0;
+      count = data.size();
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, first*sizeof(T), count*sizeof(T), data.data()+first);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+
+  unsigned int vbo_ = 0, color_vbo_ = 0;
+  size_t vertex_capacity_ = 0, color_capacity_ = 0; // elements
+  size_t uploaded_bytes_ = 0;
+  std::vector<vec2f> drawn_;
+  vec2f center_{0.0f,0.0f};
+  std::vector<float> vertices_;
+  std::vector<uint32_t> colors_;
+};
+
+OverlayBuffer overlay_buffer;
+
+void UpdateOverlay() 
+{
+  overlay_buffer.Update(line_segments, mean);
+}
+
+bool SolverStep() 
+{
+  if (line_segments.size() > 1)
+  {
+    for (unsigned int idx = 0; idx < line_segments.size()-1; ++idx) 
+      if (line_segments[line_segments.size()-1] == line_segments[idx]) 
+      {
+        if (idx == 0) return false;
+        else {
+          line_segments.erase(line_segments.begin(),line_segments.begin()+idx+1);
+          break;
+        }
+      }
+  }
+ 
+  if (line_segments.empty()) 
+  {
+    line_segments.emplace_back(points[0]);
+  }
+  else 
+  {
+    unsigned int lst = (unsigned int)(line_segments.size())-1;
+    const vec2f cur = line_segments[lst];
+    const size_t closest = WrapCandidate(points.x.data(), points.y.data(), points.size(), cur, mean);
+    const bool acute = Orient(mean, cur, cur, points[closest]) >= 0 && DotSign(mean, cur, cur, points[closest]) > 0;
+    if (acute && lst == 0) line_segments[lst] = points[closest];
+    else line_segments.emplace_back(points[closest]);
+  }
+
+  UpdateOverlay();
+  return true;
+}
+
+// Solves the whole hull in one call with the engine picked by kEngine; the result is a closed loop.
+bool SolverBatch() 
+{
+  if (!line_segments.empty()) return false;
+
+  switch (kEngine)
+  {
+    case HullEngine::kMonotoneChain: line_segments = MonotoneChain(points); break;
+    case HullEngine::kChan: line_segments = Chan(points); break;
+    case HullEngine::kDivideAndConquer: line_segments = DivideAndConquer(points, DefaultPool()); break;
+    case HullEngine::kQuickHull: line_segments = QuickHull(points, &DefaultPool()); break;
+    default: return false;
+  }
+  if (line_segments.empty()) return false;
+  line_segments.emplace_back(line_segments[0]);
+
+  UpdateOverlay();
+  return true;
+}
+
+IncrementalHull<float> incremental_hull;
+size_t inserted = 0; // points the incremental engine has taken in so far
+
+// Incremental engine: each step inserts the next share of points, as if they had just arrived, and shows
+// the hull so far as a closed loop.
+bool SolverInsert() 
+{
+  if (inserted == points.size()) return false;
+  const size_t batch = std::max<size_t>(1, (points.size()+kInsertSteps-1)/kInsertSteps);
+  for (const size_t end = std::min(points.size(), inserted+batch); inserted < end; ++inserted)
+    incremental_hull.Insert(points[inserted]);
+
+  line_segments = incremental_hull.Hull();
+  line_segments.emplace_back(line_segments[0]);
+  UpdateOverlay();
+  return true;
+}
+
+SlidingWindowHull<float> window_hull;
+size_t arrived = 0; // points the sliding window engine has taken in so far
+
+// Sliding window engine: each step the next share of points arrives and the oldest ones leave, keeping the
+// newest 1/kWindowFraction; points outside the window are dimmed. The window's hull is a closed loop.
+bool SolverWindow() 
+{
+  if (arrived == points.size()) return false;
+  const size_t batch = std::max<size_t>(1, (points.size()+kInsertSteps-1)/kInsertSteps);
+  const size_t window = std::max<size_t>(3, points.size()/kWindowFraction);
+  if (!lod && arrived == 0) std::fill(center_colors.begin(), center_colors.end(), kStaleColor);
+  for (const size_t end = std::min(points.size(), arrived+batch); arrived < end; ++arrived)
+  {
+    window_hull.Push(points[arrived]);
+    if (!lod) center_colors[arrived] = kPointColor;
+    if (window_hull.size() <= window) continue;
+    window_hull.Pop();
+    if (!lod) center_colors[arrived-window] = kStaleColor;
+  }
+  center_colors_changed = !lod;
+
+  line_segments = window_hull.Hull();
+  line_segments.emplace_back(line_segments[0]);
+  UpdateOverlay();
+  return true;
+}
+
+// One step of the engine picked by kEngine; false once it has nothing left to show.
+bool SolverAdvance() 
+{
+  switch (kEngine)
+  {
+    case HullEngine::kGiftWrap: return SolverStep();
+    case HullEngine::kIncremental: return SolverInsert();
+    case HullEngine::kSlidingWindow: return SolverWindow();
+    default: return SolverBatch();
+  }
+}
+
+// Point counts per pixel of a width x height window over NDC [-1,1]^2, row 0 at the bottom. Chunks of the
+// points count into grids of their own in parallel, then the grids are summed a band of rows per task.
+class DensityGrid 
+{
+public:
+  DensityGrid(unsigned int width, unsigned int height) : width_(width), height_(height) {}
+
+  unsigned int Width() const { return width_; }
+  unsigned int Height() const { return height_; }
+  const std::vector<uint32_t> &Counts() const { return counts_; }
+
+  void Build(const float *xs, const float *ys, size_t n, ThreadPool &pool) 
+  {
+    const size_t cells = size_t(width_)*height_;
+    const size_t chunks = std::max<size_t>(1, std::min<size_t>(pool.Size(), n/kChunkPoints));
+    partial_.resize(chunks);
+    ParallelFor(pool, chunks, chunks, [&](size_t c, size_t) {
+      std::vector<uint32_t> &grid = partial_[c];
+      grid.assign(cells, 0);
+      for (size_t i = n*c/chunks; i < n*(c+1)/chunks; ++i)
+      {
+        const float fx = (xs[i]+1.0f)*0.5f*float(width_), fy = (ys[i]+1.0f)*0.5f*float(height_);
+        if (!(fx >= 0.0f && fx < float(width_) && fy >= 0.0f && fy < float(height_))) continue;
+        ++grid[size_t(fy)*width_+size_t(fx)];
+      }
+    });
+
+    counts_.swap(partial_[0]);
+    ParallelFor(pool, height_, pool.Size(), [&](size_t row_begin, size_t row_end) {
+      for (size_t c = 1; c < chunks; ++c)
+        for (size_t i = row_begin*width_; i < row_end*width_; ++i) counts_[i] += partial_[c][i];
+    });
+  }
+
+  // Most points in any block x block square of pixels.
+  uint32_t MaxBlock(unsigned int block) const 
+  {
+    uint32_t most = 0;
+    std::vector<uint32_t> sums((width_+block-1)/block);
+    for (unsigned int y0 = 0; y0 < height_; y0 += block)
+    {
+      std::fill(sums.begin(), sums.end(), 0);
+      for (unsigned int y = y0; y < std::min(y0+block, height_); ++y)
+        for (unsigned int x = 0; x < width_; ++x) sums[x/block] += counts_[size_t(y)*width_+x];
+      most = std::max(most, *std::max_element(sums.begin(), sums.end()));
+    }
+    return most;
+  }
+
+  // RGBA8 texels, log of the count on a blue to white ramp; empty pixels keep the clear color.
+  void Colorize(std::vector<uint32_t> &texels, ThreadPool &pool) const 
+  {
+    texels.resize(counts_.size());
+    const uint32_t most = counts_.empty() ? 0 : *std::max_element(counts_.begin(), counts_.end());
+    const float scale = 1.0f/std::log(1.0f+float(std::max<uint32_t>(most, 1)));
+    const float ramp[3][3] = {{0.05f, 0.25f, 0.6f}, {0.1f, 0.8f, 0.9f}, {1.0f, 1.0f, 1.0f}};
+    ParallelFor(pool, counts_.size(), pool.Size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i)
+      {
+        if (counts_[i] == 0)
+        {
+          texels[i] = Rgba(kClearColor[0], kClearColor[1], kClearColor[2], 1.0f);
+          continue;
+        }
+        const float t = std::log(1.0f+float(counts_[i]))*scale*2.0f;
+        const float *lo = ramp[t < 1.0f ? 0 : 1], *hi = ramp[t < 1.0f ? 1 : 2];
+        const float f = t < 1.0f ? t : std::min(t-1.0f, 1.0f);
+        texels[i] = Rgba(lo[0]+(hi[0]-lo[0])*f, lo[1]+(hi[1]-lo[1])*f, lo[2]+(hi[2]-lo[2])*f, 1.0f);
+      }
+    });
+  }
+
+private:
+  static const size_t kChunkPoints = 1 << 16; // fewer points per chunk don't pay for zeroing a grid
+
+  unsigned int width_, height_;
+  std::vector<uint32_t> counts_;
+  std::vector<std::vector<uint32_t>> partial_;
+};
+
+// Draws of a frame: the ring mesh (vertices) instanced once per point center, then the overlay's triangle
+// strips in order as one multi-draw. Colors come with the vertices, so a frame is two draw calls however
+// large the hull is.
+struct FrameDraws 
+{
+  unsigned int instances = 0;
+  std::vector<int> first, count; // overlay strips, as glMultiDrawArrays takes them
+};
+
+// Vertex streams a frame reads: the ring mesh with per-instance centers and colors, and the overlay with
+// per-vertex colors. A non-empty background holds a texel per pixel, bottom row first, drawn under them.
+struct FrameStreams 
+{
+  const std::vector<float> &mesh, &centers;
+  const std::vector<uint32_t> &center_colors;
+  const std::vector<float> &overlay;
+  const std::vector<uint32_t> &overlay_colors;
+  const std::vector<uint32_t> &background;
+};
+
+// Draws of a frame with `samples` point instances and an overlay of `segments` hull points plus the mean,
+// laid out as GenerateData and BuildOverlay write them. Both render backends consume it.
+void BuildFrame(size_t samples, size_t segments, FrameDraws &draws) 
+{
+  auto add = [&](size_t first, size_t count) {
+    draws.first.emplace_back(int(first));
+    draws.count.emplace_back(int(count));
+  };
+
+  draws.instances = (unsigned int)(samples);
+  draws.first.clear();
+  draws.count.clear();
+  if (segments == 0) return;
+
+  // segment i is record i+1, the header is record 0
+  auto ring = [](size_t record) { return record*kOverlayRecord; };
+  auto line = [](size_t record) { return record*kOverlayRecord+kRingVertices; };
+  // seg lines, then the last line
+  for (size_t i = 1; i < segments; ++i) add(line(i+1), kLineVertices);
+  add(line(0), kLineVertices);
+  // seg points, then the mean
+  for (size_t i = 0; i < segments; ++i) add(ring(i+1), kRingVertices);
+  add(ring(0), kRingVertices);
+}
+
+// Headless backend: rasterizes a frame's triangle strips on the CPU into an RGB frame laid out like
+// glReadPixels output (bottom row first, rows padded to 4 bytes, Stride()*height bytes). Every pixel
+// keeps the eight sample positions of 8x MSAA, resolved by averaging; triangles are binned to tiles that
+// rasterize in parallel. Like the GL path it draws opaque, alpha is ignored. Point instances all share one
+// ring, so it is rasterized once per subpixel phase into a stamp of coverage masks, a bit per sample, and
+// each instance splats the stamp of its phase instead of binning the ring's triangles.
+class SoftwareRasterizer 
+{
+public:
+  SoftwareRasterizer(unsigned int width, unsigned int height) 
+    : width_(int(width)), height_(int(height)), stride_((3*width+3)/4*4),
+      tiles_x_((width+kTile-1)/kTile), tiles_y_((height+kTile-1)/kTile),
+      bins_(size_t(tiles_x_)*tiles_y_) {}
+
+  unsigned int Stride() const { return stride_; }
+
+  void Render(const FrameDraws &draws, const FrameStreams &streams, unsigned char *pixels, ThreadPool &pool) 
+  {
+    pixels_ = pixels;
+    background_ = streams.background.size() == size_t(width_)*height_ ? streams.background.data() : nullptr;
+    triangles_.clear();
+    splats_.clear();
+    for (auto &bin : bins_) bin.clear();
+    if (streams.mesh != mesh_) SetMesh(streams.mesh);
+    const size_t instances = std::min({size_t(draws.instances), streams.centers.size()/2, streams.center_colors.size()});
+    for (size_t inst = 0; inst < instances; ++inst)
+      AddSplat(streams.centers[2*inst], streams.centers[2*inst+1], streams.center_colors[inst]);
+    for (size_t d = 0; d < draws.first.size(); ++d)
+    {
+      const size_t first = size_t(draws.first[d]), count = size_t(draws.count[d]);
+      if (first+count > streams.overlay_colors.size() || 2*(first+count) > streams.overlay.size()) continue;
+      // strips are one color, any vertex of a triangle gives it
+      for (size_t i = first+2; i < first+count; ++i)
+        AddTriangle(&streams.overlay[2*(i-2)], 0.0f, 0.0f, streams.overlay_colors[i-2]);
+    }
+    ParallelFor(pool, bins_.size(), bins_.size(), [this](size_t tile, size_t) { RasterTile(tile); });
+  }
+
+private:
+  static const int kTile = 32;
+  static const int kPixelSamples = 8;
+  static const int kStampPhases = 16; // stamps per pixel along each axis: the 1/16 pixel sample grid
+  static const uint32_t kSplatBit = 0x80000000u; // bin entries with it set index splats_, not triangles_
+
+  // standard 8x MSAA sample positions, in 1/16 pixel from the pixel center
+  static constexpr int kSampleX[kPixelSamples] = {1, -1, 5, -3, -5, -7, 3, 7};
+  static constexpr int kSampleY[kPixelSamples] = {-3, 3, 1, -5, 5, -1, 7, -7};
+
+  // edge functions a*x+b*y+c, all non-negative inside
+  struct Triangle 
+  {
+    double a[3], b[3], c[3];
+    int x0, y0, x1, y1; // covered pixels, inclusive
+    uint32_t color;
+  };
+
+  // an instance's stamp, with its first pixel at (x,y)
+  struct Splat 
+  {
+    int x, y;
+    uint32_t stamp;
+    uint32_t color;
+  };
+
+  // Edge functions of the triangle with corners (x[k],y[k]) in pixels; false if it has no area.
+  static bool EdgeFunctions(const double *x, const double *y, Triangle &t) 
+  {
+    const double area = (x[1]-x[0])*(y[2]-y[0])-(y[1]-y[0])*(x[2]-x[0]);
+    if (area == 0.0) return false;
+    const double s = area > 0.0 ? 1.0 : -1.0;
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+      const unsigned int j = (k+1)%3;
+      t.a[k] = s*(y[k]-y[j]);
+      t.b[k] = s*(x[j]-x[k]);
+      t.c[k] = s*(x[k]*y[j]-x[j]*y[k]);
+    }
+    return true;
+  }
+
+  // Drops the stamps of the last ring and sizes them for this one: a square of stamp_side_ pixels around
+  // the ring's center pixel, with room for every phase.
+  void SetMesh(const std::vector<float> &mesh) 
+  {
+    mesh_ = mesh;
+    double extent = 0.0;
+    for (size_t i = 0; i+1 < mesh.size(); i += 2)
+      extent = std::max({extent, std::abs(double(mesh[i]))*0.5*width_, std::abs(double(mesh[i+1]))*0.5*height_});
+    stamp_reach_ = int(std::ceil(extent))+1;
+    stamp_side_ = 2*stamp_reach_+2;
+    stamps_.assign(size_t(kStampPhases)*kStampPhases, std::vector<uint8_t>());
+  }
+
+  // Coverage masks of the ring with its center at (stamp_reach_+qx/16, stamp_reach_+qy/16) in stamp pixels.
+  void BuildStamp(int qx, int qy, std::vector<uint8_t> &masks) 
+  {
+    masks.assign(size_t(stamp_side_)*stamp_side_, 0);
+    const double ox = stamp_reach_+double(qx)/kStampPhases, oy = stamp_reach_+double(qy)/kStampPhases;
+    for (size_t i = 2; i < mesh_.size()/2; ++i)
+    {
+      const float *v = &mesh_[2*(i-2)];
+      double x[3], y[3];
+      for (unsigned int k = 0; k < 3; ++k)
+      {
+        x[k] = double(v[2*k])*0.5*width_+ox;
+        y[k] = double(v[2*k+1])*0.5*height_+oy;
+      }
+      Triangle t;
+      if (!EdgeFunctions(x, y, t)) continue;
+      const int x0 = std::max(0, int(std::floor(std::min({x[0], x[1], x[2]}))));
+      const int y0 = std::max(0, int(std::floor(std::min({y[0], y[1], y[2]}))));
+      const int x1 = std::min(stamp_side_-1, int(std::floor(std::max({x[0], x[1], x[2]}))));
+      const int y1 = std::min(stamp_side_-1, int(std::floor(std::max({y[0], y[1], y[2]}))));
+      for (int py = y0; py <= y1; ++py)
+        for (int px = x0; px <= x1; ++px)
+          for (int s = 0; s < kPixelSamples; ++s)
+          {
+            const double sx = px+0.5+kSampleX[s]/16.0, sy = py+0.5+kSampleY[s]/16.0;
+            if (t.a[0]*sx+t.b[0]*sy+t.c[0] >= 0.0 && t.a[1]*sx+t.b[1]*sy+t.c[1] >= 0.0 &&
+                t.a[2]*sx+t.b[2]*sy+t.c[2] >= 0.0)
+              masks[size_t(py)*stamp_side_+px] |= uint8_t(1u << s);
+          }
+    }
+  }
+
+  // Bins the ring at center (dx,dy) in NDC: the center snaps to the nearest 1/16 pixel, whose stamp is built
+  // the first time a center lands there.
+  void AddSplat(float dx, float dy, uint32_t color) 
+  {
+    if (mesh_.size() < 6) return;
+    const double cx = (double(dx)+1.0)*0.5*width_, cy = (double(dy)+1.0)*0.5*height_;
+    if (!(std::abs(cx) < 1e9 && std::abs(cy) < 1e9)) return;
+    const long long sx = std::llround(cx*kStampPhases), sy = std::llround(cy*kStampPhases);
+    const long long ix = sx >= 0 ? sx/kStampPhases : -((-sx+kStampPhases-1)/kStampPhases);
+    const long long iy = sy >= 0 ? sy/kStampPhases : -((-sy+kStampPhases-1)/kStampPhases);
+    const int qx = int(sx-ix*kStampPhases), qy = int(sy-iy*kStampPhases);
+    const long long x0 = ix-stamp_reach_, y0 = iy-stamp_reach_;
+    const long long x1 = std::min<long long>(width_-1, x0+stamp_side_-1), y1 = std::min<long long>(height_-1, y0+stamp_side_-1);
+    if (x1 < std::max<long long>(0, x0) || y1 < std::max<long long>(0, y0)) return;
+
+    const uint32_t stamp = uint32_t(qy*kStampPhases+qx);
+    if (stamps_[stamp].empty()) BuildStamp(qx, qy, stamps_[stamp]);
+    const uint32_t index = uint32_t(splats_.size()) | kSplatBit;
+    splats_.emplace_back(Splat{int(x0), int(y0), stamp, color});
+    for (long long ty = std::max<long long>(0, y0)/kTile; ty <= y1/kTile; ++ty)
+      for (long long tx = std::max<long long>(0, x0)/kTile; tx <= x1/kTile; ++tx)
+        bins_[size_t(ty)*tiles_x_+size_t(tx)].emplace_back(index);
+  }
+
+  void SplatTile(const Splat &splat, int tx0, int ty0, int tx1, int ty1, std::vector<uint32_t> &samples) const 
+  {
+    const std::vector<uint8_t> &masks = stamps_[splat.stamp];
+    for (int py = std::max(ty0, splat.y); py <= std::min(ty1, splat.y+stamp_side_-1); ++py)
+      for (int px = std::max(tx0, splat.x); px <= std::min(tx1, splat.x+stamp_side_-1); ++px)
+      {
+        const unsigned int mask = masks[size_t(py-splat.y)*stamp_side_+(px-splat.x)];
+        if (mask == 0) continue;
+        uint32_t *dst = &samples[(size_t(py-ty0)*kTile+(px-tx0))*kPixelSamples];
+        if (mask == 0xffu) std::fill(dst, dst+kPixelSamples, splat.color);
+        else
+          for (int s = 0; s < kPixelSamples; ++s)
+            if (mask & (1u << s)) dst[s] = splat.color;
+      }
+  }
+
+  // v holds three consecutive strip vertices in NDC, moved by (dx,dy) like the shader's center
+  void AddTriangle(const float *v, float dx, float dy, uint32_t color) 
+  {
+    double x[3], y[3];
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+      x[k] = (double(v[2*k]+dx)+1.0)*0.5*width_;
+      y[k] = (double(v[2*k+1]+dy)+1.0)*0.5*height_;
+    }
+    Triangle t;
+    if (!EdgeFunctions(x, y, t)) return;
+    t.x0 = std::max(0, int(std::floor(std::min({x[0], x[1], x[2]}))));
+    t.y0 = std::max(0, int(std::floor(std::min({y[0], y[1], y[2]}))));
+    t.x1 = std::min(width_-1, int(std::floor(std::max({x[0], x[1], x[2]}))));
+    t.y1 = std::min(height_-1, int(std::floor(std::max({y[0], y[1], y[2]}))));
+    if (t.x0 > t.x1 || t.y0 > t.y1) return;
+    t.color = color;
+
+    const uint32_t index = uint32_t(triangles_.size());
+    triangles_.emplace_back(t);
+    for (int ty = t.y0/kTile; ty <= t.y1/kTile; ++ty)
+      for (int tx = t.x0/kTile; tx <= t.x1/kTile; ++tx) bins_[size_t(ty)*tiles_x_+tx].emplace_back(index);
+  }
+
+  void RasterTile(size_t tile) 
+  {
+    const int tx0 = int(tile%tiles_x_)*kTile, ty0 = int(tile/tiles_x_)*kTile;
+    const int tx1 = std::min(tx0+kTile, width_)-1, ty1 = std::min(ty0+kTile, height_)-1;
+    const uint32_t clear = Rgba(kClearColor[0], kClearColor[1], kClearColor[2], 1.0f);
+    auto under = [&](int px, int py) { return background_ ? background_[size_t(py)*width_+px] : clear; };
+    if (bins_[tile].empty())
+    {
+      for (int py = ty0; py <= ty1; ++py)
+        for (int px = tx0; px <= tx1; ++px)
+        {
+          const uint32_t texel = under(px, py);
+          for (unsigned int c = 0; c < 3; ++c) pixels_[size_t(py)*stride_+3*size_t(px)+c] = (unsigned char)((texel >> (8*c)) & 0xff);
+        }
+      return;
+    }
+
+    std::vector<uint32_t> &samples = TileSamples();
+    if (!background_) std::fill(samples.begin(), samples.end(), clear);
+    else
+      for (int py = ty0; py <= ty1; ++py)
+        for (int px = tx0; px <= tx1; ++px)
+        {
+          uint32_t *dst = &samples[(size_t(py-ty0)*kTile+(px-tx0))*kPixelSamples];
+          std::fill(dst, dst+kPixelSamples, under(px, py));
+        }
+
+    for (const uint32_t index : bins_[tile])
+    {
+      if (index & kSplatBit)
+      {
+        SplatTile(splats_[index & ~kSplatBit], tx0, ty0, tx1, ty1, samples);
+        continue;
+      }
+      const Triangle &t = triangles_[index];
+      double offset[3][kPixelSamples], lo[3], hi[3];
+      for (unsigned int k = 0; k < 3; ++k)
+      {
+        lo[k] = hi[k] = t.a[k]*0.5+t.b[k]*0.5;
+        for (int s = 0; s < kPixelSamples; ++s)
+        {
+          offset[k][s] = t.a[k]*(0.5+kSampleX[s]/16.0)+t.b[k]*(0.5+kSampleY[s]/16.0);
+          lo[k] = std::min(lo[k], offset[k][s]);
+          hi[k] = std::max(hi[k], offset[k][s]);
+        }
+      }
+
+      for (int py = std::max(ty0, t.y0); py <= std::min(ty1, t.y1); ++py)
+      {
+        // span of the row that can reach the triangle, so long thin lines don't walk their bounding box
+        double x_lo = std::max(tx0, t.x0), x_hi = std::min(tx1, t.x1);
+        for (unsigned int k = 0; k < 3 && x_hi-x_lo > 8.0; ++k)
+        {
+          const double edge = t.b[k]*py+t.c[k]+hi[k];
+          if (t.a[k] > 0.0) x_lo = std::max(x_lo, std::floor(-edge/t.a[k]));
+          else if (t.a[k] < 0.0) x_hi = std::min(x_hi, std::ceil(-edge/t.a[k]));
+          else if (edge < 0.0) x_hi = -1.0;
+        }
+        if (x_lo > x_hi) continue;
+        for (int px = int(x_lo); px <= int(x_hi); ++px)
+        {
+          const double e0 = t.a[0]*px+t.b[0]*py+t.c[0];
+          const double e1 = t.a[1]*px+t.b[1]*py+t.c[1];
+          const double e2 = t.a[2]*px+t.b[2]*py+t.c[2];
+          if (e0+hi[0] < 0.0 || e1+hi[1] < 0.0 || e2+hi[2] < 0.0) continue;
+          uint32_t *dst = &samples[(size_t(py-ty0)*kTile+(px-tx0))*kPixelSamples];
+          if (e0+lo[0] >= 0.0 && e1+lo[1] >= 0.0 && e2+lo[2] >= 0.0)
+          {
+            std::fill(dst, dst+kPixelSamples, t.color);
+            continue;
+          }
+          for (int s = 0; s < kPixelSamples; ++s)
+            if (e0+offset[0][s] >= 0.0 && e1+offset[1][s] >= 0.0 && e2+offset[2][s] >= 0.0) dst[s] = t.color;
+        }
+      }
+    }
+
+    // resolve
+    for (int py = ty0; py <= ty1; ++py)
+      for (int px = tx0; px <= tx1; ++px)
+      {
+        const uint32_t *src = &samples[(size_t(py-ty0)*kTile+(px-tx0))*kPixelSamples];
+        unsigned char *dst = &pixels_[size_t(py)*stride_+3*size_t(px)];
+        if (std::all_of(src+1, src+kPixelSamples, [&](uint32_t v) { return v == src[0]; }))
+        {
+          for (unsigned int c = 0; c < 3; ++c) dst[c] = (unsigned char)((src[0] >> (8*c)) & 0xff);
+          continue;
+        }
+        for (unsigned int c = 0; c < 3; ++c)
+        {
+          unsigned int sum = 0;
+          for (int s = 0; s < kPixelSamples; ++s) sum += (src[s] >> (8*c)) & 0xff;
+          dst[c] = (unsigned char)((sum+kPixelSamples/2)/kPixelSamples);
+        }
+      }
+  }
+
+  // per-thread sample storage of one tile
+  static std::vector<uint32_t> &TileSamples() 
+  {
+    thread_local std::vector<uint32_t> samples(size_t(kTile)*kTile*kPixelSamples);
+    return samples;
+  }
+
+  int width_, height_;
+  unsigned int stride_;
+  unsigned int tiles_x_, tiles_y_;
+  unsigned char *pixels_ = nullptr;
+  const uint32_t *background_ = nullptr;
+  std::vector<std::vector<uint32_t>> bins_;
+  std::vector<Triangle> triangles_;
+  std::vector<Splat> splats_;
+  std::vector<float> mesh_; // the ring the stamps are of
+  int stamp_reach_ = 0, stamp_side_ = 0;
+  std::vector<std::vector<uint8_t>> stamps_; // by phase, empty until first used
+};
+
+// Writes a bottom-up RGB frame as <dir>/<k>.png and returns the path. Expects
+// stbi_flip_vertically_on_write(true), set once in main.
+std::string SaveFrame(const std::string &dir, int k, const void *pixels, int stride) 
+{
+  const std::string path = dir+"/"+std::to_string(k)+std::string(".png");
+  stbi_write_png(path.c_str(), kWinWidth, kWinHeight, 3, pixels, stride);
+  return path;
+}
+
+// PNG encoding off the render thread: captured frames queue up for a few encoder threads. Frame buffers
+// come from a fixed pool and return to it once encoded, so Acquire blocks while every buffer is in flight;
+// that bounds the queue and throttles the producer. Every acquired frame must be submitted. Memory the
+// writer doesn't own can be queued too, with a callback run once it has been encoded.
+class FrameWriter 
+{
+public:
+  using Frame = std::vector<unsigned char>;
+
+  FrameWriter(std::string dir, unsigned int encoders, size_t buffers, size_t frame_bytes, bool log = true) 
+    : dir_(std::move(dir)), log_(log), frames_(std::max<size_t>(1, buffers), Frame(frame_bytes)) 
+  {
+    for (auto &frame : frames_) free_.emplace_back(&frame);
+    for (unsigned int i = 0; i < std::max(1u, encoders); ++i) encoders_.emplace_back([this] { Encode(); });
+  }
+
+  // Writes out everything still queued.
+  ~FrameWriter() 
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    queued_.notify_all();
+    for (auto &encoder : encoders_) encoder.join();
+  }
+
+  Frame *Acquire() 
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    freed_.wait(lock, [this] { return !free_.empty(); });
+    Frame *frame = free_.back();
+    free_.pop_back();
+    return frame;
+  }
+
+  void Submit(int k, Frame *frame, int stride) 
+  {
+    Push(Job{k, frame->data(), stride, frame, nullptr});
+  }
+
+  // pixels must stay valid until done() is called from an encoder thread.
+  void Submit(int k, const unsigned char *pixels, int stride, std::function<void()> done) 
+  {
+    Push(Job{k, pixels, stride, nullptr, std::move(done)});
+  }
+
+  // Waits until every submitted frame is written.
+  void Flush() 
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    freed_.wait(lock, [this] { return pending_ == 0; });
+  }
+
+private:
+  struct Job 
+  {
+    int k;
+    const unsigned char *pixels;
+    int stride;
+    Frame *frame; // returns to the pool when encoded, if set
+    std::function<void()> done;
+  };
+
+  void Push(Job job) 
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.push_back(std::move(job));
+      ++pending_;
+    }
+    queued_.notify_one();
+  }
+
+  void Encode() 
+  {
+    while (true)
+    {
+      Job job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        queued_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+        if (jobs_.empty()) return;
+        job = std::move(jobs_.front());
+        jobs_.pop_front();
+      }
+      const std::string path = SaveFrame(dir_, job.k, job.pixels, job.stride);
+      if (log_) std::cout << path+"\n";
+      if (job.done) job.done();
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (job.frame) free_.emplace_back(job.frame);
+        --pending_;
+      }
+      freed_.notify_all();
+    }
+  }
+
+  std::string dir_;
+  bool log_;
+  std::vector<Frame> frames_;
+  std::vector<Frame *> free_;
+  std::deque<Job> jobs_;
+  std::vector<std::thread> encoders_;
+  std::mutex mutex_;
+  std::condition_variable queued_, freed_;
+  size_t pending_ = 0;
+  bool stop_ = false;
+};
+
+// Asynchronous readback through a ring of pixel pack buffers: glReadPixels of a saved frame goes into the
+// next PBO with a fence behind it, so the GPU copies while the following frames render. A PBO is mapped
+// only once its fence has signaled and the mapped memory goes to the FrameWriter as is; it is unmapped
+// when the encoder is done. Only the GL thread may call in; the ring blocks only when every PBO is busy.
+class PboCapture 
+{
+public:
+  PboCapture(FrameWriter &writer, unsigned int slots, int stride, size_t frame_bytes) 
+    : writer_(writer), stride_(stride), frame_bytes_(frame_bytes) 
+  {
+    for (unsigned int i = 0; i < std::max(1u, slots); ++i)
+    {
+      slots_.emplace_back(std::make_unique<Slot>());
+      glGenBuffers(1, &slots_.back()->pbo);
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, slots_.back()->pbo);
+      glBufferData(GL_PIXEL_PACK_BUFFER, GLsizeiptr(frame_bytes), NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  }
+
+  // Needs the GL context: writes out every pending frame before releasing the buffers.
+  ~PboCapture() 
+  {
+    for (size_t i = 0; i < slots_.size(); ++i) Reclaim(*slots_[(next_+i)%slots_.size()]);
+    for (auto &slot : slots_) glDeleteBuffers(1, &slot->pbo);
+  }
+
+  // Starts reading the current read buffer back as frame k.
+  void Capture(int k) 
+  {
+    Slot &slot = *slots_[next_];
+    Reclaim(slot);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glReadPixels(0, 0, kWinWidth, kWinHeight, GL_RGB, GL_UNSIGNED_BYTE, (void*)0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.k = k;
+    slot.state = State::kReading;
+    next_ = (next_+1)%slots_.size();
+  }
+
+  // Hands finished readbacks to the writer and unmaps what it has encoded, oldest first, without waiting.
+  void Poll() 
+  {
+    for (size_t i = 0; i < slots_.size(); ++i)
+    {
+      Slot &slot = *slots_[(next_+i)%slots_.size()];
+      if (slot.state == State::kReading)
+      {
+        const GLenum status = glClientWaitSync(slot.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+        Encode(slot);
+      }
+      if (slot.state == State::kEncoding && slot.encoded.load(std::memory_order_acquire)) Unmap(slot);
+    }
+  }
+
+private:
+  enum class State { kFree, kReading, kEncoding };
+
+  struct Slot 
+  {
+    unsigned int pbo = 0;
+    GLsync fence = nullptr;
+    int k = 0;
+    State state = State::kFree;
+    std::atomic<bool> encoded{false};
+  };
+
+  // A PBO that fails to map is copied into a pooled frame instead, synchronously; the framebuffer has moved
+  // on by now, but the PBO still holds frame k. The slot is free again right away, with nothing to unmap.
+  void Encode(Slot &slot) 
+  {
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    const void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, GLsizeiptr(frame_bytes_), GL_MAP_READ_BIT);
+    if (!pixels)
+    {
+      std::cerr << "frame " << slot.k << ": cannot map its pixel buffer (GL error " << glGetError()
+                << "), reading it back synchronously\n";
+      FrameWriter::Frame *frame = writer_.Acquire();
+      glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, GLsizeiptr(frame_bytes_), frame->data());
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+      writer_.Submit(slot.k, frame, stride_);
+      slot.state = State::kFree;
+      return;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.encoded.store(false, std::memory_order_relaxed);
+    slot.state = State::kEncoding;
+    writer_.Submit(slot.k, static_cast<const unsigned char *>(pixels), stride_,
+                   [&slot] { slot.encoded.store(true, std::memory_order_release); });
+  }
+
+  void Unmap(Slot &slot) 
+  {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.state = State::kFree;
+  }
+
+  // Blocks until the slot is free again.
+  void Reclaim(Slot &slot) 
+  {
+    if (slot.state == State::kReading)
+    {
+      while (glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+      Encode(slot);
+    }
+    if (slot.state == State::kEncoding)
+    {
+      while (!slot.encoded.load(std::memory_order_acquire)) std::this_thread::yield();
+      Unmap(slot);
+    }
+  }
+
+  FrameWriter &writer_;
+  int stride_;
+  size_t frame_bytes_;
+  std::vector<std::unique_ptr<Slot>> slots_;
+  size_t next_ = 0;
+};
+
+// Point files: text with two numbers at the start of each line, separated by commas, tabs, semicolons or
+// spaces (CSV, TSV and plain columns alike; lines that don't start with two numbers, like a header, are
+// skipped), or raw little-endian x,y pairs of float32 (.f32, .bin) or float64 (.f64).
+enum class PointFormat { kText, kFloat32, kFloat64 };
+
+PointFormat FormatOf(const std::string &path) 
+{
+  if (input_format == "text") return PointFormat::kText;
+  if (input_format == "f32") return PointFormat::kFloat32;
+  if (input_format == "f64") return PointFormat::kFloat64;
+  const std::string ext = std::filesystem::path(path).extension().string();
+  if (ext == ".f32" || ext == ".bin") return PointFormat::kFloat32;
+  if (ext == ".f64") return PointFormat::kFloat64;
+  return PointFormat::kText;
+}
+
+// What a load of this format skips: header or malformed lines, or raw records that aren't finite.
+const char *SkippedRecords(PointFormat format) 
+{
+  return format == PointFormat::kText ? " lines" : " non-finite records";
+}
+
+bool ReadFile(const std::string &path, std::vector<char> &data) 
+{
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) return false;
+  data.resize(size_t(file.tellg()));
+  file.seekg(0);
+  return bool(file.read(data.data(), std::streamsize(data.size())));
+}
+
+// One chunk's points, in the coordinate type they're kept in, with the sums and bounds the load needs,
+// gathered while parsing.
+template <class T>
+struct LoadedChunk 
+{
+  std::vector<T> x, y;
+  double sum_x = 0.0, sum_y = 0.0;
+  T lo_x = std::numeric_limits<T>::max(), lo_y = std::numeric_limits<T>::max();
+  T hi_x = std::numeric_limits<T>::lowest(), hi_y = std::numeric_limits<T>::lowest();
+  size_t skipped = 0; // text lines that don't start with two finite numbers
+  std::vector<size_t> dropped; // binary records with a non-finite coordinate, by position in the chunk
+
+  // Records the chunk covers: its points, and for binary input the pairs dropped between them.
+  size_t Records() const { return x.size()+dropped.size(); }
+
+  // Position among the chunk's records of its i-th point.
+  size_t RecordOf(size_t i) const 
+  {
+    for (const size_t d : dropped)
+    {
+      if (d > i) break;
+      ++i;
+    }
+    return i;
+  }
+
+  void Add(T px, T py) 
+  {
+    x.emplace_back(px);
+    y.emplace_back(py);
+    sum_x += px;
+    sum_y += py;
+    lo_x = std::min(lo_x, px);
+    lo_y = std::min(lo_y, py);
+    hi_x = std::max(hi_x, px);
+    hi_y = std::max(hi_y, py);
+  }
+};
+
+// std::from_chars for T with a fast path for plain decimals such as "-12.345678". Up to 19 digits without
+// an exponent are read as an integer m and a count k of fractional digits; while m fits a double's
+// significand and 10^k is exact, m/10^k is a correctly rounded double. A float rounded from it is correct
+// unless the double fell exactly halfway between two floats. Anything else goes to from_chars.
+template <class T>
+std::from_chars_result ParseNumber(const char *first, const char *end, T &value) 
+{
+  static constexpr double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  const char *p = first;
+  const bool negative = p < end && *p == '-';
+  p += negative;
+  uint64_t m = 0;
+  int digits = 0, k = 0;
+  bool point = false;
+  for (; p < end; ++p)
+  {
+    const unsigned int d = unsigned(*p-'0');
+    if (d < 10)
+    {
+      if (++digits <= 19) m = 10*m+d;
+      k += point;
+    }
+    else if (*p == '.' && !point) point = true;
+    else break;
+  }
+  if (digits == 0 || digits > 19 || k > 22 || m > (uint64_t(1) << 53) || (p < end && (*p == 'e' || *p == 'E')))
+    return std::from_chars(first, end, value);
+  const double v = double(m)/kPow10[k];
+  if constexpr (std::is_same_v<T, float>)
+  {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    const uint64_t below = (uint64_t(1) << 29)-1; // double significand bits a float drops
+    if ((bits & below) == (below+1)/2) return std::from_chars(first, end, value);
+  }
+  value = T(negative ? -v : v);
+  return {p, std::errc()};
+}
+
+template <class T>
+void ParseText(const char *begin, const char *end, LoadedChunk<T> &chunk) 
+{
+  auto separator = [](char c) { return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r'; };
+  // from_chars stops at the line break and separators never skip it, so a line is parsed without finding
+  // its end first; the rest of it is skipped afterwards
+  for (const char *p = begin; p < end; )
+  {
+    T v[2];
+    int got = 0;
+    for (; got < 2; ++got)
+    {
+      while (p < end && separator(*p)) ++p;
+      const auto parsed = ParseNumber(p, end, v[got]);
+      if (parsed.ec != std::errc()) break;
+      p = parsed.ptr;
+    }
+    const char *eol = end;
+    if (p < end)
+    {
+      const void *nl = *p == '\n' ? p : std::memchr(p, '\n', size_t(end-p));
+      if (nl) eol = static_cast<const char *>(nl);
+    }
+    if (got == 2 && std::isfinite(v[0]) && std::isfinite(v[1])) chunk.Add(v[0], v[1]);
+    else if (got > 0 || p < eol) ++chunk.skipped;
+    p = eol+1;
+  }
+}
+
+// n pairs of S read into a chunk of T; a pair that isn't finite in T is dropped and its position kept.
+template <class S, class T>
+void ParseBinary(const char *begin, size_t n, LoadedChunk<T> &chunk) 
+{
+  chunk.x.reserve(n);
+  chunk.y.reserve(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    const T px = T(LoadLittleEndian<S>(begin+2*sizeof(S)*i));
+    const T py = T(LoadLittleEndian<S>(begin+(2*i+1)*sizeof(S)));
+    if (std::isfinite(px) && std::isfinite(py)) chunk.Add(px, py);
+    else chunk.dropped.emplace_back(i);
+  }
+}
+
+// Parses [begin,end) into parts, in chunks on the pool; text chunks end at line breaks, binary ranges must
+// hold whole x,y pairs.
+template <class T>
+void ParseChunks(const char *begin, const char *end, PointFormat format, std::vector<LoadedChunk<T>> &parts,
+                 ThreadPool &pool) 
+{
+  const size_t kChunkBytes = size_t(1) << 20;
+  const size_t bytes = size_t(end-begin);
+  const size_t chunks = std::max<size_t>(1, std::min<size_t>(4*pool.Size(), bytes/kChunkBytes));
+  parts.assign(chunks, LoadedChunk<T>());
+  if (format == PointFormat::kText)
+  {
+    std::vector<const char *> bounds(chunks+1, end);
+    bounds[0] = begin;
+    for (size_t c = 1; c < chunks; ++c)
+    {
+      const char *from = std::max<const char *>(bounds[c-1], begin+bytes*c/chunks);
+      const char *eol = static_cast<const char *>(std::memchr(from, '\n', size_t(end-from)));
+      bounds[c] = eol ? eol+1 : end;
+    }
+    ParallelFor(pool, chunks, chunks, [&](size_t c, size_t) { ParseText(bounds[c], bounds[c+1], parts[c]); });
+  }
+  else
+  {
+    const size_t pair = format == PointFormat::kFloat32 ? 2*sizeof(float) : 2*sizeof(double);
+    const size_t n = bytes/pair;
+    ParallelFor(pool, chunks, chunks, [&](size_t c, size_t) {
+      const size_t first = n*c/chunks, count = n*(c+1)/chunks-first;
+      if (format == PointFormat::kFloat32) ParseBinary<float>(begin+pair*first, count, parts[c]);
+      else ParseBinary<double>(begin+pair*first, count, parts[c]);
+    });
+  }
+}
+
+// Uniform scale that keeps the hull, taking the box [lo,hi] to [-0.9, 0.9] along its longer side; mid gets
+// the box center.
+template <class T>
+T FitScale(const vec2<T> &lo, const vec2<T> &hi, vec2<T> &mid) 
+{
+  const T extent = std::max(hi.x-lo.x, hi.y-lo.y);
+  mid = vec2<T>{T(0.5)*(lo.x+hi.x), T(0.5)*(lo.y+hi.y)};
+  return extent > T(0) ? T(1.8)/extent : T(1);
+}
+
+// Fills pts from the file at path and center with their mean, both moved and scaled uniformly so the
+// points' bounding box fits the window like the generated points. The file is parsed in chunks on the
+// pool, text chunks ending at line breaks; each chunk sums and bounds its points as it parses them. Points
+// are read and fitted in double, like StreamScene does, and only the fitted points are rounded to float.
+bool LoadPoints(const std::string &path, PointSet<float> &pts, vec2f &center, ThreadPool &pool) 
+{
+  std::vector<char> data;
+  if (!ReadFile(path, data))
+  {
+    std::cerr << "cannot read " << path << "\n";
+    return false;
+  }
+
+  const PointFormat format = FormatOf(path);
+  if (format != PointFormat::kText)
+  {
+    const size_t pair = format == PointFormat::kFloat32 ? 2*sizeof(float) : 2*sizeof(double);
+    if (data.size()%pair != 0) std::cout << path << ": ignoring " << data.size()%pair << " trailing bytes\n";
+  }
+  std::vector<LoadedChunk<double>> loaded;
+  ParseChunks(data.data(), data.data()+data.size(), format, loaded, pool);
+  const size_t chunks = loaded.size();
+
+  std::vector<size_t> offsets(chunks+1, 0);
+  double sum_x = 0.0, sum_y = 0.0;
+  double lo_x = std::numeric_limits<double>::max(), lo_y = lo_x, hi_x = std::numeric_limits<double>::lowest(), hi_y = hi_x;
+  size_t skipped = 0;
+  for (size_t c = 0; c < chunks; ++c)
+  {
+    const LoadedChunk<double> &chunk = loaded[c];
+    offsets[c+1] = offsets[c]+chunk.x.size();
+    sum_x += chunk.sum_x;
+    sum_y += chunk.sum_y;
+    lo_x = std::min(lo_x, chunk.lo_x);
+    lo_y = std::min(lo_y, chunk.lo_y);
+    hi_x = std::max(hi_x, chunk.hi_x);
+    hi_y = std::max(hi_y, chunk.hi_y);
+    skipped += chunk.skipped+chunk.dropped.size();
+  }
+  const size_t n = offsets[chunks];
+  if (n == 0)
+  {
+    std::cerr << "no points in " << path << "\n";
+    return false;
+  }
+
+  vec2<double> mid;
+  const double scale = FitScale(vec2<double>{lo_x, lo_y}, vec2<double>{hi_x, hi_y}, mid);
+  pts.clear();
+  pts.x.resize(n);
+  pts.y.resize(n);
+  ParallelFor(pool, chunks, chunks, [&](size_t c, size_t) {
+    const LoadedChunk<double> &chunk = loaded[c];
+    for (size_t i = 0; i < chunk.x.size(); ++i)
+    {
+      pts.x[offsets[c]+i] = float((chunk.x[i]-mid.x)*scale);
+      pts.y[offsets[c]+i] = float((chunk.y[i]-mid.y)*scale);
+    }
+  });
+  center = vec2f{float((sum_x/double(n)-mid.x)*scale), float((sum_y/double(n)-mid.y)*scale)};
+
+  std::cout << "loaded " << n << " points from " << path;
+  if (skipped > 0) std::cout << ", skipped " << skipped << SkippedRecords(format);
+  std::cout << "\n";
+  return true;
+}
+
+// Running hull of a point stream in O(h) memory, for inputs too big to hold. Each batch is checked on the
+// pool against a circle inscribed in the hull so far, which settles most interior points with one multiply
+// per axis, then the hull itself; the survivors of each chunk are cut to their own hull, and only those meet
+// the running hull in a monotone chain. Interior points are gone as soon as their batch is. Points keep the
+// input's coordinate type and are numbered by record in stream order, dropped binary records included, so
+// a raw file gives the positions its mapped hull does.
+template <class T>
+class StreamingHull 
+{
+public:
+  using Point = vec2<T>;
+
+  void Add(const std::vector<LoadedChunk<T>> &parts, ThreadPool &pool) 
+  {
+    using Candidate = std::pair<size_t, Point>;
+    std::vector<size_t> offsets(parts.size()+1, count_);
+    for (size_t c = 0; c < parts.size(); ++c) offsets[c+1] = offsets[c]+parts[c].Records();
+    std::vector<std::vector<Candidate>> kept(parts.size());
+    ParallelFor(pool, parts.size(), parts.size(), [&](size_t c, size_t) {
+      const LoadedChunk<T> &part = parts[c];
+      PointSet<T> survivors;
+      std::vector<size_t> positions, order, hull; // positions: where in the part each survivor sits
+      for (size_t i = 0; i < part.x.size(); ++i)
+      {
+        const double dx = double(part.x[i])-center_.x, dy = double(part.y[i])-center_.y;
+        if (dx*dx+dy*dy < radius2_) continue;
+        const Point pt{part.x[i], part.y[i]};
+        if (InsideHull(points_, pt)) continue;
+        survivors.push_back(pt);
+        positions.emplace_back(i);
+      }
+      survivors.track_index();
+      AklToussaint(survivors); // only does work while the hull is small, like on the first batch
+
+      order.resize(survivors.size());
+      for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+      hull.resize(order.size()+1);
+      hull.resize(MonotoneChain(order.data(), order.data()+order.size(), hull.data(), [&](size_t i) { return survivors[i]; }));
+      for (const size_t i : hull) kept[c].emplace_back(offsets[c]+part.RecordOf(positions[survivors.index[i]]), survivors[i]);
+    });
+
+    std::vector<Candidate> candidates;
+    for (size_t i = 0; i < points_.size(); ++i) candidates.emplace_back(indices_[i], points_[i]);
+    for (const auto &part_hull : kept) candidates.insert(candidates.end(), part_hull.begin(), part_hull.end());
+    std::vector<Candidate> hull(candidates.size()+1);
+    hull.resize(MonotoneChain(candidates.data(), candidates.data()+candidates.size(), hull.data(), At));
+    indices_.clear();
+    points_.clear();
+    for (const auto &e : hull)
+    {
+      indices_.emplace_back(e.first);
+      points_.emplace_back(e.second);
+    }
+    Inscribe();
+
+    count_ = offsets.back();
+    for (const auto &part : parts)
+    {
+      points_count_ += part.x.size();
+      sum_x_ += part.sum_x;
+      sum_y_ += part.sum_y;
+      skipped_ += part.skipped+part.dropped.size();
+    }
+  }
+
+  // Counter-clockwise like MonotoneChain, with each point's position in the stream.
+  const std::vector<Point> &Hull() const { return points_; }
+  const std::vector<size_t> &Indices() const { return indices_; }
+  size_t Count() const { return points_count_; }
+  size_t Skipped() const { return skipped_; }
+  vec2<double> Mean() const 
+  {
+    if (points_count_ == 0) return vec2<double>{0.0, 0.0};
+    return vec2<double>{sum_x_/double(points_count_), sum_y_/double(points_count_)};
+  }
+
+private:
+  static const Point &At(const std::pair<size_t, Point> &e) { return e.second; }
+
+  // Circle around the vertex mean touching the nearest edge line, shrunk well past the rounding of the
+  // distances and of the coordinates' magnitude, so whatever lies inside it is strictly inside the hull.
+  // Edges too long to measure in double leave the hull test alone.
+  void Inscribe() 
+  {
+    radius2_ = -1.0;
+    if (points_.size() < 3) return;
+    center_ = {0.0, 0.0};
+    double magnitude = 0.0;
+    for (const auto &pt : points_)
+    {
+      center_ = {center_.x+pt.x, center_.y+pt.y};
+      magnitude = std::max({magnitude, std::abs(double(pt.x)), std::abs(double(pt.y))});
+    }
+    center_ = {center_.x/double(points_.size()), center_.y/double(points_.size())};
+    double radius = std::numeric_limits<double>::max();
+    for (size_t i = 0; i < points_.size(); ++i)
+    {
+      const Point &a = points_[i], &b = points_[i+1 == points_.size() ? 0 : i+1];
+      const double ex = double(b.x)-a.x, ey = double(b.y)-a.y;
+      const double l = ex*(center_.y-a.y), r = ey*(center_.x-a.x);
+      const double dist = (l-r-kPredicateErrBound*(std::abs(l)+std::abs(r)))/std::sqrt(ex*ex+ey*ey);
+      if (!std::isfinite(dist)) return;
+      radius = std::min(radius, dist);
+    }
+    radius = radius*(1.0-1e-6)-64.0*std::numeric_limits<double>::epsilon()*magnitude;
+    radius2_ = radius > 0.0 ? radius*radius : -1.0;
+  }
+
+  std::vector<size_t> indices_;
+  std::vector<Point> points_;
+  vec2<double> center_{0.0, 0.0};
+  double radius2_ = -1.0;
+  size_t count_ = 0, points_count_ = 0, skipped_ = 0; // count_: records so far, the next one's position
+  double sum_x_ = 0.0, sum_y_ = 0.0;
+};
+
+// Reads a FILE in blocks on a thread of its own, up to `ahead` blocks before the consumer, so the read
+// overlaps whatever the consumer does with the previous block.
+class BlockReader 
+{
+public:
+  BlockReader(FILE *file, size_t block_bytes, size_t ahead) 
+    : file_(file), block_bytes_(block_bytes), ahead_(std::max<size_t>(1, ahead)), reader_([this] { Read(); }) 
+  {
+  }
+
+  ~BlockReader() 
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    freed_.notify_all();
+    reader_.join();
+  }
+
+  // Moves the next block into block, taking the one it held back for reuse; false once the file is done.
+  bool Next(std::vector<char> &block) 
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      read_.wait(lock, [this] { return !blocks_.empty() || done_; });
+      if (blocks_.empty()) return false;
+      if (block.capacity() > 0) spare_.emplace_back(std::move(block));
+      block = std::move(blocks_.front());
+      blocks_.pop_front();
+    }
+    freed_.notify_one();
+    return true;
+  }
+
+  // True if the file ended in a read error rather than at its end.
+  bool Failed() 
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failed_;
+  }
+
+private:
+  void Read() 
+  {
+    while (true)
+    {
+      std::vector<char> block;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        freed_.wait(lock, [this] { return stop_ || blocks_.size() < ahead_; });
+        if (stop_) return;
+        if (!spare_.empty())
+        {
+          block = std::move(spare_.back());
+          spare_.pop_back();
+        }
+      }
+      block.resize(block_bytes_);
+      block.resize(std::fread(block.data(), 1, block.size(), file_));
+      const bool end = block.size() < block_bytes_;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!block.empty()) blocks_.emplace_back(std::move(block));
+        done_ = end;
+        failed_ = end && std::ferror(file_) != 0;
+      }
+      read_.notify_one();
+      if (end) return;
+    }
+  }
+
+  FILE *file_;
+  size_t block_bytes_, ahead_;
+  std::mutex mutex_;
+  std::condition_variable read_, freed_;
+  std::deque<std::vector<char>> blocks_;
+  std::vector<std::vector<char>> spare_;
+  bool stop_ = false, done_ = false, failed_ = false;
+  std::thread reader_;
+};
+
+const size_t kStreamBlock = size_t(8) << 20; // bytes StreamPoints reads at a time
+
+// Feeds the points in the file at path, or stdin for "-", to hull a block at a time. Text blocks are parsed
+// up to their last line break and binary blocks up to their last whole pair, the rest carried into the next
+// block; there the carry plus the block's head that completes it, up to its first line break or pair, is
+// parsed as a piece of its own and the rest of the block in place, so no block is copied. Memory holds the
+// blocks in flight and the hull whatever the input's size, and with the next block read while this one is
+// parsed the read is what bounds the throughput.
+template <class T>
+bool StreamPoints(const std::string &path, StreamingHull<T> &hull, ThreadPool &pool) 
+{
+  FILE *file = path == "-" ? stdin : std::fopen(path.c_str(), "rb");
+  if (!file)
+  {
+    std::cerr << "cannot read " << path << "\n";
+    return false;
+  }
+  const PointFormat format = FormatOf(path);
+  const size_t pair = format == PointFormat::kText ? 1 : format == PointFormat::kFloat32 ? 2*sizeof(float) : 2*sizeof(double);
+
+  std::vector<char> block, carry;
+  std::vector<LoadedChunk<T>> parts;
+  bool failed = false;
+  {
+    BlockReader reader(file, kStreamBlock, 2);
+    while (reader.Next(block))
+    {
+      const char *begin = block.data(), *end = begin+block.size();
+      if (!carry.empty())
+      {
+        const char *head = end;
+        if (format != PointFormat::kText) head = begin+std::min(pair-carry.size(), block.size());
+        else if (const void *nl = std::memchr(begin, '\n', block.size())) head = static_cast<const char *>(nl)+1;
+        carry.insert(carry.end(), begin, head);
+        begin = head;
+        if (format == PointFormat::kText ? carry.back() != '\n' : carry.size() < pair) continue; // still open
+        ParseChunks(carry.data(), carry.data()+carry.size(), format, parts, pool);
+        hull.Add(parts, pool);
+        carry.clear();
+      }
+      const char *cut = begin+size_t(end-begin)/pair*pair;
+      if (format == PointFormat::kText)
+        while (cut > begin && cut[-1] != '\n') --cut;
+      ParseChunks(begin, cut, format, parts, pool);
+      hull.Add(parts, pool);
+      carry.assign(cut, end);
+    }
+    failed = reader.Failed();
+  }
+  if (file != stdin) std::fclose(file);
+  if (failed)
+  {
+    std::cerr << "read error in " << path << "\n";
+    return false;
+  }
+
+  if (format == PointFormat::kText)
+  {
+    ParseChunks(carry.data(), carry.data()+carry.size(), format, parts, pool); // last line, no line break
+    hull.Add(parts, pool);
+  }
+  else if (!carry.empty()) std::cerr << path << ": ignoring " << carry.size() << " trailing bytes\n";
+  return true;
+}
+
+// Streams the input into pts, which ends up holding just its hull, fitted to the window like LoadPoints
+// does; center gets the mean of every point streamed. The hull is found in double and only the fitted
+// points are rounded to float.
+bool StreamScene(const std::string &path, PointSet<float> &pts, vec2f &center, ThreadPool &pool) 
+{
+  StreamingHull<double> hull;
+  if (!StreamPoints(path, hull, pool)) return false;
+  if (hull.Count() == 0)
+  {
+    std::cerr << "no points in " << path << "\n";
+    return false;
+  }
+
+  vec2<double> lo = hull.Hull()[0], hi = lo;
+  for (const auto &pt : hull.Hull())
+  {
+    lo = vec2<double>{std::min(lo.x, pt.x), std::min(lo.y, pt.y)};
+    hi = vec2<double>{std::max(hi.x, pt.x), std::max(hi.y, pt.y)};
+  }
+  vec2<double> mid;
+  const double scale = FitScale(lo, hi, mid);
+  auto fit = [&](const vec2<double> &pt) { return vec2f{float((pt.x-mid.x)*scale), float((pt.y-mid.y)*scale)}; };
+  pts.clear();
+  for (const auto &pt : hull.Hull()) pts.push_back(fit(pt));
+  center = fit(hull.Mean());
+
+  std::cout << "streamed " << hull.Count() << " points from " << path << ", " << pts.size() << " on the hull";
+  if (hull.Skipped() > 0) std::cout << ", skipped " << hull.Skipped() << SkippedRecords(FormatOf(path));
+  std::cout << "\n";
+  return true;
+}
+
+// Rings while no ring-sized square of the window holds more than kLodRingsPerBlock points, the density
+// heatmap otherwise. The grid has to see every point, so this runs before the prefilter.
+void SetupPointLayer() 
+{
+  vertices.clear();
+  DrawPoint(vec2f{0.0f,0.0f}, vertices);
+
+  DensityGrid density(kWinWidth, kWinHeight);
+  density.Build(points.x.data(), points.y.data(), points.size(), DefaultPool());
+  const unsigned int ring_pixels = (unsigned int)(std::ceil(kRingOuter*float(kWinWidth)));
+  lod = density.MaxBlock(ring_pixels) > kLodRingsPerBlock;
+
+  centers.clear();
+  center_colors.clear();
+  heatmap.clear();
+  if (lod) density.Colorize(heatmap, DefaultPool());
+  else
+  {
+    centers.reserve(2*points.size());
+    for (size_t i = 0; i < points.size(); ++i) centers.insert(centers.end(), {points.x[i], points.y[i]});
+    center_colors.assign(points.size(), kPointColor);
+  }
+
+  if (headless) return;
+  Upload(VAO, VBO, vertices);
+  if (lod) UploadHeatmap(heatmap_texture, heatmap, kWinWidth, kWinHeight);
+  else
+  {
+    UploadCenters(VAO, VBOc, centers);
+    UploadCenterColors(VAO, VBOcc, center_colors);
+  }
+}
+
+// Generates the points, or with --input loads them from a file, or streams them from one (--stream, or "-"
+// for stdin) down to their hull; then sets up the point layer, applies the prefilter and clears the output
+// directory.
+bool SetupScene() 
+{
+  if (input_path.empty()) GenerateData();
+  else if (stream_input || input_path == "-")
+  {
+    if (!StreamScene(input_path, points, mean, DefaultPool())) return false;
+  }
+  else if (!LoadPoints(input_path, points, mean, DefaultPool())) return false;
+  SetupPointLayer();
+  // a point inside the hull of all of them can still be on a window's hull
+  if (kPrefilter && kEngine != HullEngine::kSlidingWindow)
+  {
+    const size_t discarded = AklToussaint(points);
+    std::cout << "prefilter discarded " << discarded << " of " << discarded+points.size() << " points\n";
+  }
+
+  namespace fs = std::filesystem;
+  fs::remove_all(out_dir);
+  fs::create_directories(out_dir);
+  return true;
+}
+
+// Renders every solver step with the software rasterizer, no window or GL context needed.
+int RunHeadless() 
+{
+  headless = true;
+  if (!SetupScene()) return 1;
+
+  SoftwareRasterizer raster(kWinWidth, kWinHeight);
+  FrameWriter writer(out_dir, kEncoderThreads, kFrameBuffers, size_t(raster.Stride())*kWinHeight);
+  const FrameStreams streams{vertices, centers, center_colors, overlay_buffer.Vertices(), overlay_buffer.Colors(), heatmap};
+  FrameDraws draws;
+  int k = 0;
+  while (SolverAdvance())
+  {
+    BuildFrame(centers.size()/2, line_segments.size(), draws);
+    FrameWriter::Frame *frame = writer.Acquire();
+    raster.Render(draws, streams, frame->data(), DefaultPool());
+    writer.Submit(++k, frame, int(raster.Stride()));
+  }
+  return 0;
+}
+
+template <class F>
+double TimeMs(F &&f) 
+{
+  const auto begin = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-begin).count();
+}
+
+// Peak resident set of the process so far, MB; 0 where getrusage isn't available.
+double PeakRssMb() 
+{
+#ifdef HULL_MMAP
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+  return double(usage.ru_maxrss)/1e6; // bytes
+#else
+  return double(usage.ru_maxrss)/1e3; // kilobytes
+#endif
+#else
+  return 0.0;
+#endif
+}
+
+template <class T>
+int MappedHull(const std::string &path) 
+{
+  MappedPoints<T> pts;
+  if (!pts.Open(path))
+  {
+    std::cerr << "cannot map " << path << "\n";
+    return 1;
+  }
+  std::vector<size_t> hull;
+  size_t skipped = 0;
+  const double t = TimeMs([&] { hull = HullIndices(pts, DefaultPool(), &skipped); });
+  std::string out;
+  for (const size_t i : hull) out += std::to_string(i)+"\n";
+  std::cout << out;
+  std::cerr << pts.size()-skipped << " points, " << hull.size() << " on the hull, " << t << " ms, peak rss " << PeakRssMb() << " MB";
+  if (skipped > 0) std::cerr << ", skipped " << skipped << SkippedRecords(PointFormat::kFloat64);
+  std::cerr << "\n";
+  return 0;
+}
+
+template <class T>
+int StreamedHull(const std::string &path) 
+{
+  StreamingHull<T> hull;
+  bool streamed = false;
+  const double t = TimeMs([&] { streamed = StreamPoints(path, hull, DefaultPool()); });
+  if (!streamed) return 1;
+  std::string out;
+  for (const size_t i : hull.Indices()) out += std::to_string(i)+"\n";
+  std::cout << out;
+  std::cerr << hull.Count() << " points, " << hull.Indices().size() << " on the hull, " << t << " ms, peak rss "
+            << PeakRssMb() << " MB";
+  if (hull.Skipped() > 0) std::cerr << ", skipped " << hull.Skipped() << SkippedRecords(FormatOf(path));
+  std::cerr << "\n";
+  return 0;
+}
+
+// Prints the hull of a point file as positions of its points, counter-clockwise, one per line. Raw files
+// are mapped, not loaded, for archives too big to copy; text files and stdin ("-") go through a streaming
+// hull in the input's precision (double for text), where positions count the points read in text and the
+// records of raw input, as the mapped path does.
+int RunHull(const std::string &path) 
+{
+  const PointFormat format = FormatOf(path);
+  if (path == "-") return format == PointFormat::kFloat32 ? StreamedHull<float>(path) : StreamedHull<double>(path);
+  switch (format)
+  {
+    case PointFormat::kFloat32: return MappedHull<float>(path);
+    case PointFormat::kFloat64: return MappedHull<double>(path);
+    default: return StreamedHull<double>(path);
+  }
+}
+
+// n points with exactly h of them on the hull: h on a circle, the rest strictly inside the inscribed polygon.
+std::vector<vec2f> MakeHullTestSet(size_t n, size_t h, std::mt19937 &gen) 
+{
+  std::vector<vec2f> pts;
+  pts.reserve(n);
+  const float r_out = 0.9f;
+  const float r_in = 0.99f*r_out*std::cos(PI/float(h));
+  std::uniform_real_distribution<float> dist(-r_in, r_in);
+  for (size_t i = 0; i < h; ++i)
+  {
+    const float ang = 2*PI*float(i)/float(h);
+    pts.emplace_back(vec2f{std::cos(ang),std::sin(ang)}*r_out);
+  }
+  while (pts.size() < n)
+  {
+    vec2f pt = {dist(gen),dist(gen)};
+    if (pt.norm() < r_in) pts.emplace_back(pt);
+  }
+  std::shuffle(pts.begin(), pts.end(), gen);
+  return pts;
+}
+
+// n points uniform in the unit disc: few reach the hull, and the octagon leaves work behind.
+std::vector<vec2f> RandomDisc(size_t n, std::mt19937 &gen) 
+{
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<vec2f> pts(n);
+  for (auto &pt : pts)
+    do pt = vec2f{dist(gen), dist(gen)}; while (pt.x*pt.x+pt.y*pt.y > 1.0f);
+  return pts;
+}
+
+// A bench's directory under the system temp directory, created empty and removed with its files on every
+// way out of the bench.
+class TempDir 
+{
+public:
+  explicit TempDir(const char *name) : path_(std::filesystem::temp_directory_path()/name) 
+  {
+    std::filesystem::remove_all(path_);
+    std::filesystem::create_directories(path_);
+  }
+
+  ~TempDir() 
+  {
+    std::error_code error;
+    std::filesystem::remove_all(path_, error);
+  }
+
+  TempDir(const TempDir &) = delete;
+  TempDir &operator=(const TempDir &) = delete;
+
+  std::string Path() const { return path_.string(); }
+  std::string File(const char *name) const { return (path_/name).string(); }
+
+private:
+  std::filesystem::path path_;
+};
+
+void BenchChan() 
+{
+  std::mt19937 gen(42);
+  const size_t n = 1000000;
+  std::cout << "chan vs gift wrap, n = " << n << "\n";
+  std::cout << "       h       h/n  giftwrap,ms      chan,ms  monotone,ms\n";
+  for (size_t h : {4, 16, 32, 64, 128, 256, 1024})
+  {
+    const auto pts = MakeHullTestSet(n, h, gen);
+    size_t h_wrap = 0, h_chan = 0, h_mono = 0;
+    const double t_wrap = TimeMs([&] { h_wrap = GiftWrap(pts).size(); });
+    const double t_chan = TimeMs([&] { h_chan = Chan(pts).size(); });
+    const double t_mono = TimeMs([&] { h_mono = MonotoneChain(pts).size(); });
+    std::printf("%8zu  %8.1e  %11.1f  %11.1f  %11.1f%s\n", h, double(h)/double(n), t_wrap, t_chan, t_mono,
+                (h_wrap == h && h_chan == h && h_mono == h) ? "" : "  MISMATCH");
+  }
+}
+
+void BenchPrefilter() 
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> dist(-0.9f, 0.9f);
+  std::cout << "akl-toussaint prefilter, uniform square\n";
+  std::cout << "         n    kept,%  filter,ms  chan,ms  filter+chan,ms\n";
+  for (size_t n : {1000, 100000, 10000000})
+  {
+    std::vector<vec2f> pts(n);
+    for (auto &pt : pts) pt = {dist(gen),dist(gen)};
+    auto kept = pts;
+    size_t discarded = 0, h_full = 0, h_kept = 0;
+    const double t_filter = TimeMs([&] { discarded = AklToussaint(kept); });
+    const double t_full = TimeMs([&] { h_full = Chan(pts).size(); });
+    const double t_kept = TimeMs([&] { h_kept = Chan(kept).size(); });
+    std::printf("%10zu  %8.3f  %9.1f  %7.1f  %14.1f%s\n", n, 100.0*double(n-discarded)/double(n),
+                t_filter, t_full, t_filter+t_kept, h_full == h_kept ? "" : "  MISMATCH");
+  }
+}
+
+void BenchParallel() 
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> dist(-0.9f, 0.9f);
+  const size_t n = 10000000;
+  std::vector<vec2f> pts(n);
+  for (auto &pt : pts) pt = {dist(gen),dist(gen)};
+  const size_t h = MonotoneChain(pts).size();
+
+  std::cout << "parallel divide and conquer, uniform square, n = " << n << "\n";
+  std::cout << " threads       ms  speedup\n";
+  const unsigned int max_threads = std::max(1u, std::thread::hardware_concurrency());
+  double t_one = 0.0;
+  for (unsigned int threads = 1; threads <= max_threads; threads = (threads == max_threads) ? threads+1 : std::min(2*threads, max_threads))
+  {
+    ThreadPool pool(threads);
+    size_t h_par = 0;
+    const double t = TimeMs([&] { h_par = DivideAndConquer(pts, pool).size(); });
+    if (threads == 1) t_one = t;
+    std::printf("%8u  %7.1f  %7.2f%s\n", threads, t, t_one/t, h_par == h ? "" : "  MISMATCH");
+  }
+}
+
+void BenchWrapStep() 
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> dist(-0.9f, 0.9f);
+  const size_t n = 1000000;
+  const int reps = 20;
+  std::vector<vec2f> pts(n);
+  for (auto &pt : pts) pt = {dist(gen),dist(gen)};
+  const vec2f from = {0.0f, 0.0f};
+
+  // the angle scan SolverStep used before orientation predicates
+  auto atan2_scan = [&](const vec2f &cur) {
+    const vec2f ref = cur-from;
+    size_t closest = 0;
+    float min_ang = 360.0f;
+    for (size_t idx = 0; idx < pts.size(); ++idx)
+    {
+      vec2f v2 = pts[idx]-cur;
+      if (v2.norm() == 0.0f) continue;
+      float ang = atan2f(ref.cross(v2), ref.dot(v2))*180.0f/PI;
+      if (ang < 0) ang = 180.f - ang;
+      if (ang < min_ang)
+      {
+        min_ang = ang;
+        closest = idx;
+      }
+    }
+    return closest;
+  };
+
+  std::vector<float> xs(n), ys(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    xs[i] = pts[i].x;
+    ys[i] = pts[i].y;
+  }
+
+  // a different wrapping point per rep keeps the compiler from hoisting the scan out of the loop
+  size_t c_atan2 = 0;
+  const double t_atan2 = TimeMs([&] { for (int r = 0; r < reps; ++r) c_atan2 += atan2_scan(pts[r]); });
+  std::cout << "wrap step candidate cost, n = " << n << "\n";
+  std::printf("  atan2f      %6.2f ns/candidate\n", 1e6*t_atan2/double(n*reps));
+
+  const std::pair<SimdLevel, const char *> kernels[] = {
+    {SimdLevel::kScalar, "predicates"}, {SimdLevel::kAvx2, "avx2"}, {SimdLevel::kAvx512, "avx512"}};
+  for (const auto &kernel : kernels)
+  {
+    if (kernel.first > kSimd) break;
+    size_t c_pred = 0;
+    const double t_pred = TimeMs([&] {
+      for (int r = 0; r < reps; ++r) c_pred += WrapCandidate(xs.data(), ys.data(), n, pts[r], from, kernel.first);
+    });
+    std::printf("  %-10s  %6.2f ns/candidate%s\n", kernel.second, 1e6*t_pred/double(n*reps), c_atan2 == c_pred ? "" : "  MISMATCH");
+  }
+}
+
+void BenchRobust() 
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> dist(-0.9f, 0.9f);
+  const size_t n = 10000000;
+  std::vector<vec2f> pts(n+2);
+  for (auto &pt : pts) pt = {dist(gen),dist(gen)};
+
+  // plain float orientation, the predicate every engine used before the filter
+  auto float_orient = [](const vec2f &o, const vec2f &a, const vec2f &b) {
+    const float c = (a.x-o.x)*(b.y-o.y)-(a.y-o.y)*(b.x-o.x);
+    return (c > 0.0f)-(c < 0.0f);
+  };
+  // each step depends on the previous sign, as in a hull stack, so neither loop is vectorized away
+  auto walk = [&](auto orient, size_t &calls) {
+    long long sum = 0;
+    for (size_t i = 0; i < n; ++calls)
+    {
+      const int sign = orient(pts[i], pts[i+1], pts[i+2]);
+      sum += sign;
+      i += 1+(sign > 0);
+    }
+    return sum;
+  };
+  size_t c_float = 0, c_robust = 0;
+  long long s_float = 0, s_robust = 0;
+  const double t_float = TimeMs([&] { s_float = walk(float_orient, c_float); });
+  const double t_robust = TimeMs([&] {
+    s_robust = walk([](const vec2f &o, const vec2f &a, const vec2f &b) { return Orient(o, a, b); }, c_robust);
+  });
+  std::cout << "robust orientation, random triples\n";
+  std::printf("  float     %6.2f ns/call\n", 1e6*t_float/double(c_float));
+  std::printf("  filtered  %6.2f ns/call  (%+.1f%%)%s\n", 1e6*t_robust/double(c_robust), 100.0*(t_robust/t_float-1.0),
+              s_float == s_robust ? "" : "  SIGN MISMATCH");
+
+  std::cout << "exact path hits during MonotoneChain\n";
+  std::cout << "  input              n   exact     hull\n";
+  const size_t m = 1000000;
+  std::uniform_int_distribution<int> grid(-100, 100);
+  std::vector<std::pair<const char *, std::vector<vec2f>>> inputs(4);
+  inputs[0].first = "uniform";
+  inputs[1].first = "grid 201x201";
+  inputs[2].first = "circle";
+  inputs[3].first = "line y=x/3";
+  for (size_t i = 0; i < m; ++i)
+  {
+    const float ang = 2*PI*dist(gen);
+    const float t = dist(gen);
+    inputs[0].second.emplace_back(vec2f{dist(gen),dist(gen)});
+    inputs[1].second.emplace_back(vec2f{float(grid(gen)),float(grid(gen))}*0.009f);
+    inputs[2].second.emplace_back(vec2f{std::cos(ang),std::sin(ang)}*0.9f);
+    inputs[3].second.emplace_back(vec2f{t,t/3.0f});
+  }
+  for (const auto &input : inputs)
+  {
+    const unsigned long long before = exact_predicates.load();
+    const size_t h = MonotoneChain(input.second).size();
+    std::printf("  %-12s  %7zu  %6llu  %7zu\n", input.first, m, exact_predicates.load()-before, h);
+  }
+}
+
+// One engine on the same points held as float, double, int32 and int64 coordinates.
+template <class F>
+void BenchCoordinateRow(const char *name, const std::vector<vec2i> &lattice, F &&engine) 
+{
+  // lattice points with 23 fraction bits are exact in every type; int64 shifts them far past int32's range
+  std::vector<vec2f> pts_f;
+  std::vector<vec2d> pts_d;
+  std::vector<vec2l> pts_l;
+  for (const auto &p : lattice)
+  {
+    pts_f.emplace_back(vec2f{float(p.x)*0x1p-23f, float(p.y)*0x1p-23f});
+    pts_d.emplace_back(vec2d{double(p.x)*0x1p-23, double(p.y)*0x1p-23});
+    pts_l.emplace_back(vec2l{int64_t(p.x)*(int64_t(1) << 36), int64_t(p.y)*(int64_t(1) << 36)});
+  }
+  size_t h[4] = {};
+  const double t_f = TimeMs([&] { h[0] = engine(pts_f).size(); });
+  const double t_d = TimeMs([&] { h[1] = engine(pts_d).size(); });
+  const double t_i = TimeMs([&] { h[2] = engine(lattice).size(); });
+  const double t_l = TimeMs([&] { h[3] = engine(pts_l).size(); });
+  std::printf("  %-10s  %7.1f  %7.1f  %7.1f  %7.1f%s\n", name, t_f, t_d, t_i, t_l,
+              (h[0] == h[1] && h[0] == h[2] && h[0] == h[3]) ? "" : "  MISMATCH");
+}
+
+void BenchCoordinates() 
+{
+  std::mt19937 gen(42);
+  const size_t n = 1000000;
+  const int32_t r = int32_t(0.9*0x1p23);
+  std::uniform_int_distribution<int32_t> dist(-r, r);
+  std::vector<vec2i> uniform(n), circle;
+  for (auto &pt : uniform) pt = {dist(gen), dist(gen)};
+  for (const auto &pt : MakeHullTestSet(n, 1024, gen))
+    circle.emplace_back(vec2i{int32_t(std::lround(pt.x*0x1p23f)), int32_t(std::lround(pt.y*0x1p23f))});
+
+  const std::pair<const char *, const std::vector<vec2i> *> inputs[] = {{"uniform square", &uniform}, {"1024 on a circle", &circle}};
+  for (const auto &input : inputs)
+  {
+    std::cout << "coordinate types, " << input.first << ", n = " << n << "\n";
+    std::cout << "  engine        float,ms double,ms  int32,ms  int64,ms\n";
+    const auto &pts = *input.second;
+    BenchCoordinateRow("monotone", pts, [](const auto &p) { return MonotoneChain(p); });
+    BenchCoordinateRow("chan", pts, [](const auto &p) { return Chan(p); });
+    BenchCoordinateRow("quickhull", pts, [](const auto &p) { return QuickHull(p, nullptr); });
+    BenchCoordinateRow("d&c", pts, [](const auto &p) { return DivideAndConquer(p, DefaultPool()); });
+  }
+}
+
+// The point layer drawn as one triangle strip per point, a draw each, against one shared ring mesh plus a
+// center per instance and a single instanced draw: building the vertex buffers, their size, the draws a
+// frame issues and the frame itself through the software rasterizer (only while per-point strips stay
+// affordable there; a GL frame needs a context).
+void BenchPointLayer() 
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> dist(-0.9f, 0.9f);
+  const size_t kMaxFramed = 10000;
+  auto draw_calls = [](const FrameDraws &draws) { return draws.first.size()+(draws.instances > 0 ? 1 : 0); };
+  std::cout << "point layer, per-point strips vs instanced ring mesh, 1 frame through the software rasterizer\n";
+  std::cout << "         n  strips,ms  strips,MB    draws  frame,ms  instanced,ms  instanced,MB  draws  frame,ms\n";
+  for (size_t n : {1000, 10000, 100000, 1000000})
+  {
+    std::vector<vec2f> pts(n);
+    for (auto &pt : pts) pt = {dist(gen),dist(gen)};
+
+    std::vector<float> strips, ring, ring_centers;
+    std::vector<uint32_t> ring_colors;
+    const double t_strips = TimeMs([&] {
+      strips.reserve(2*kRingVertices*n);
+      for (const auto &pt : pts) DrawPoint(pt, strips);
+    });
+    const double t_instanced = TimeMs([&] {
+      DrawPoint(vec2f{0.0f, 0.0f}, ring);
+      ring_centers.reserve(2*n);
+      for (const auto &pt : pts) ring_centers.insert(ring_centers.end(), {pt.x, pt.y});
+      ring_colors.assign(n, kPointColor);
+    });
+    const size_t instanced_bytes = (ring.size()+ring_centers.size())*sizeof(float)+ring_colors.size()*sizeof(uint32_t);
+
+    FrameDraws strip_draws, instanced_draws;
+    for (size_t i = 0; i < n; ++i)
+    {
+      strip_draws.first.emplace_back(int(i*kRingVertices));
+      strip_draws.count.emplace_back(int(kRingVertices));
+    }
+    instanced_draws.instances = (unsigned int)(n);
+    double t_strip_frame = -1.0, t_instanced_frame = -1.0;
+    if (n <= kMaxFramed)
+    {
+      const std::vector<float> no_floats;
+      const std::vector<uint32_t> no_colors, strip_colors(n*kRingVertices, kPointColor);
+      SoftwareRasterizer raster(kWinWidth, kWinHeight);
+      std::vector<unsigned char> frame(size_t(raster.Stride())*kWinHeight);
+      t_strip_frame = TimeMs([&] {
+        raster.Render(strip_draws, FrameStreams{no_floats, no_floats, no_colors, strips, strip_colors, no_colors},
+                      frame.data(), DefaultPool());
+      });
+      t_instanced_frame = TimeMs([&] {
+        raster.Render(instanced_draws, FrameStreams{ring, ring_centers, ring_colors, no_floats, no_colors, no_colors},
+                      frame.data(), DefaultPool());
+      });
+    }
+    auto frame_ms = [](double t) { return t < 0.0 ? std::string("-") : std::to_string(int(std::lround(t))); };
+    std::printf("%10zu  %9.1f  %9.1f  %7zu  %8s  %12.2f  %12.2f  %5zu  %8s\n", n, t_strips,
+                double(strips.size()*sizeof(float))/1e6, draw_calls(strip_draws), frame_ms(t_strip_frame).c_str(),
+                t_instanced, double(instanced_bytes)/1e6, draw_calls(instanced_draws), frame_ms(t_instanced_frame).c_str());
+  }
+}
+
+// Ring vertex generation: cos and sin per node with a temporary vector per quad, as DrawPoint used to,
+// against translating the compile-time ring template into a buffer sized up front.
+void BenchVertices() 
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> dist(-0.9f, 0.9f);
+  auto draw_trig = [](const vec2f &center, std::vector<float> &container) {
+    vec2f A = center + vec2f{kRingOuter,0};
+    vec2f B = center + vec2f{kRingInner,0};
+    for (unsigned int j=1; j<=kPointNodes; ++j)
+    {
+      const float ang = 2*PI*j/float(kPointNodes);
+      vec2f dir = {std::cos(ang),std::sin(ang)};
+      vec2f C = center + dir*kRingOuter;
+      vec2f D = center + dir*kRingInner;
+      std::vector<float> line = {C.x,C.y,A.x,A.y,D.x,D.y,B.x,B.y};
+      std::copy(line.begin(), line.end(), std::back_inserter(container));
+      A = C;
+      B = D;
+    }
+  };
+
+  std::cout << "ring vertex generation, " << kRingVertices << " vertices per point, Mvertices/s\n";
+  std::cout << "        n    trig,ms  trig,Mv/s  table,ms  table,Mv/s  max diff\n";
+  for (size_t n : {1000, 10000, 100000})
+  {
+    std::vector<vec2f> pts(n);
+    for (auto &pt : pts) pt = {dist(gen),dist(gen)};
+
+    std::vector<float> trig, table(2*kRingVertices*n);
+    const double t_trig = TimeMs([&] {
+      for (const auto &pt : pts) draw_trig(pt, trig);
+    });
+    const double t_table = TimeMs([&] {
+      for (size_t i = 0; i < n; ++i) DrawPoint(pts[i], &table[2*kRingVertices*i]);
+    });
+    float diff = 0.0f;
+    for (size_t i = 0; i < table.size(); ++i) diff = std::max(diff, std::abs(table[i]-trig[i]));
+    const double vertices = double(kRingVertices*n);
+    std::printf("%9zu  %9.2f  %9.1f  %8.2f  %10.1f  %8.1e\n", n, t_trig, vertices/t_trig/1e3, t_table,
+                vertices/t_table/1e3, double(diff));
+  }
+}
+
+// Overlay upkeep while the wrap grows the hull one segment per step: rebuilding every ring and line and
+// re-uploading all of it, against appending the new record.
+void BenchOverlay() 
+{
+  std::cout << "overlay update over a whole wrap, segments added one per step\n";
+  std::cout << "      h  rebuild,ms  rebuild,MB  append,ms  append,MB\n";
+  for (size_t h : {16, 128, 1024})
+  {
+    std::vector<vec2f> hull;
+    for (size_t i = 0; i < h; ++i)
+    {
+      const float ang = 2*PI*float(i)/float(h);
+      hull.emplace_back(vec2f{std::cos(ang),std::sin(ang)}*0.9f);
+    }
+    const vec2f center{0.0f, 0.0f};
+
+    std::vector<float> rebuilt;
+    std::vector<uint32_t> rebuilt_colors;
+    size_t rebuilt_bytes = 0;
+    const double t_rebuild = TimeMs([&] {
+      std::vector<vec2f> segments;
+      for (const auto &pt : hull)
+      {
+        segments.emplace_back(pt);
+        BuildOverlay(segments, center, rebuilt, rebuilt_colors);
+        rebuilt_bytes += rebuilt.size()*sizeof(float)+rebuilt_colors.size()*sizeof(uint32_t);
+      }
+    });
+    OverlayBuffer buffer;
+    const double t_append = TimeMs([&] {
+      std::vector<vec2f> segments;
+      for (const auto &pt : hull)
+      {
+        segments.emplace_back(pt);
+        buffer.Update(segments, center);
+      }
+    });
+    std::printf("%7zu  %10.2f  %10.1f  %9.2f  %9.1f%s\n", h, t_rebuild, double(rebuilt_bytes)/1e6, t_append,
+                double(buffer.UploadedBytes())/1e6,
+                buffer.Vertices() == rebuilt && buffer.Colors() == rebuilt_colors ? "" : "  MISMATCH");
+  }
+}
+
+void BenchRaster() 
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> dist(-0.9f, 0.9f);
+  const int frames = 20;
+  std::cout << "software rasterizer, " << kWinWidth << "x" << kWinHeight << ", 8 samples, ms/frame\n";
+  std::cout << "    points   hull  threads  ms/frame\n";
+  for (size_t n : {20, 1000, 10000})
+  {
+    std::vector<vec2f> pts(n);
+    std::vector<float> ring, ring_centers, overlay;
+    std::vector<uint32_t> ring_colors(n, kPointColor), overlay_colors;
+    DrawPoint(vec2f{0.0f, 0.0f}, ring);
+    vec2f center{0.0f, 0.0f};
+    for (auto &pt : pts)
+    {
+      pt = {dist(gen),dist(gen)};
+      ring_centers.insert(ring_centers.end(), {pt.x, pt.y});
+      center = center + pt*(1.0f/float(n));
+    }
+    const auto hull = MonotoneChain(pts);
+    BuildOverlay(hull, center, overlay, overlay_colors);
+    FrameDraws draws;
+    BuildFrame(n, hull.size(), draws);
+    const std::vector<uint32_t> background;
+    const FrameStreams streams{ring, ring_centers, ring_colors, overlay, overlay_colors, background};
+
+    const unsigned int max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int threads : {1u, max_threads})
+    {
+      ThreadPool pool(threads);
+      SoftwareRasterizer raster(kWinWidth, kWinHeight);
+      std::vector<unsigned char> frame(size_t(raster.Stride())*kWinHeight);
+      const double t = TimeMs([&] {
+        for (int f = 0; f < frames; ++f) raster.Render(draws, streams, frame.data(), pool);
+      });
+      std::printf("%10zu  %5zu  %7u  %8.2f\n", n, hull.size(), threads, t/frames);
+      if (threads == max_threads) break;
+    }
+  }
+}
+
+// Level of detail: building the density grid and its heatmap, then the software-rendered frame with the
+// heatmap under the hull against one with a ring per point (only run while that stays affordable).
+void BenchLod() 
+{
+  std::mt19937 gen(42);
+  std::normal_distribution<float> dist(0.0f, 0.3f);
+  const unsigned int ring_pixels = (unsigned int)(std::ceil(kRingOuter*float(kWinWidth)));
+  std::cout << "level of detail, " << kWinWidth << "x" << kWinHeight << " density grid, normal(0, 0.3) points\n";
+  std::cout << "         n  grid,ms  colorize,ms  max/ring  mode     heatmap,ms/frame  rings,ms/frame\n";
+  for (size_t n : {1000, 10000, 1000000, 10000000})
+  {
+    PointSet<float> pts;
+    pts.reserve(n);
+    for (size_t i = 0; i < n; ++i) pts.push_back(vec2f{dist(gen),dist(gen)});
+    const float *xs = pts.x.data(), *ys = pts.y.data();
+    const auto hull = MonotoneChain(pts);
+
+    DensityGrid density(kWinWidth, kWinHeight);
+    std::vector<uint32_t> texels;
+    const double t_grid = TimeMs([&] { density.Build(xs, ys, n, DefaultPool()); });
+    const double t_colorize = TimeMs([&] { density.Colorize(texels, DefaultPool()); });
+    const uint32_t most = density.MaxBlock(ring_pixels);
+
+    std::vector<float> ring, overlay;
+    std::vector<uint32_t> overlay_colors;
+    DrawPoint(vec2f{0.0f, 0.0f}, ring);
+    BuildOverlay(hull, vec2f{0.0f, 0.0f}, overlay, overlay_colors);
+    SoftwareRasterizer raster(kWinWidth, kWinHeight);
+    std::vector<unsigned char> frame(size_t(raster.Stride())*kWinHeight);
+    FrameDraws draws;
+
+    const std::vector<float> no_centers;
+    const std::vector<uint32_t> no_colors;
+    BuildFrame(0, hull.size(), draws);
+    const double t_heatmap = TimeMs([&] {
+      raster.Render(draws, FrameStreams{ring, no_centers, no_colors, overlay, overlay_colors, texels}, frame.data(), DefaultPool());
+    });
+
+    double t_rings = -1.0;
+    if (n <= 10000)
+    {
+      std::vector<float> ring_centers;
+      for (size_t i = 0; i < n; ++i) ring_centers.insert(ring_centers.end(), {xs[i], ys[i]});
+      const std::vector<uint32_t> ring_colors(n, kPointColor);
+      BuildFrame(n, hull.size(), draws);
+      t_rings = TimeMs([&] {
+        raster.Render(draws, FrameStreams{ring, ring_centers, ring_colors, overlay, overlay_colors, no_colors}, frame.data(),
+                      DefaultPool());
+      });
+    }
+    std::printf("%10zu  %7.2f  %11.2f  %8u  %-7s  %16.2f  ", n, t_grid, t_colorize, most,
+                most > kLodRingsPerBlock ? "heatmap" : "rings", t_heatmap);
+    if (t_rings < 0.0) std::printf("%14s\n", "-");
+    else std::printf("%14.2f\n", t_rings);
+  }
+}
+
+// Point file loading against just reading the file: text parsing is meant to keep up with the read.
+void BenchLoad() 
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> dist(-1000.0, 1000.0);
+  const size_t n = 4000000;
+  const TempDir dir("convex_hull_load");
+
+  std::vector<double> coords(2*n);
+  for (auto &c : coords) c = dist(gen);
+  const std::pair<const char *, char> texts[] = {{"points.csv", ','}, {"points.tsv", '\t'}, {"points.txt", ' '}};
+  for (const auto &text : texts)
+  {
+    std::ofstream file(dir.File(text.first), std::ios::binary);
+    std::string line;
+    char number[32];
+    for (size_t i = 0; i < n; ++i)
+    {
+      line.clear();
+      line.append(number, std::to_chars(number, number+sizeof(number), coords[2*i], std::chars_format::fixed, 6).ptr);
+      line += text.second;
+      line.append(number, std::to_chars(number, number+sizeof(number), coords[2*i+1], std::chars_format::fixed, 6).ptr);
+      line += '\n';
+      file << line;
+    }
+  }
+  {
+    std::ofstream f32(dir.File("points.f32"), std::ios::binary), f64(dir.File("points.f64"), std::ios::binary);
+    for (double c : coords)
+    {
+      const float f = float(c);
+      f32.write(reinterpret_cast<const char *>(&f), sizeof(f));
+      f64.write(reinterpret_cast<const char *>(&c), sizeof(c));
+    }
+  }
+
+  std::cout << "point file loading, n = " << n << ", files in the page cache\n";
+  std::cout << "  file          MB  read,ms  read,MB/s  load,ms  load,MB/s  1 thread,ms\n";
+  for (const char *name : {"points.csv", "points.tsv", "points.txt", "points.f32", "points.f64"})
+  {
+    const std::string path = dir.File(name);
+    const double mb = double(std::filesystem::file_size(path))/1e6;
+    std::vector<char> data;
+    ReadFile(path, data);
+    const double t_read = TimeMs([&] { ReadFile(path, data); });
+    PointSet<float> pts;
+    vec2f center{0.0f, 0.0f};
+    std::streambuf *out = std::cout.rdbuf(nullptr);
+    const double t_load = TimeMs([&] { LoadPoints(path, pts, center, DefaultPool()); });
+    ThreadPool single(1);
+    const double t_single = TimeMs([&] { LoadPoints(path, pts, center, single); });
+    std::cout.rdbuf(out);
+    std::printf("  %-10s  %6.1f  %7.1f  %9.0f  %7.1f  %9.0f  %11.1f%s\n", name, mb, t_read, mb/t_read*1e3, t_load,
+                mb/t_load*1e3, t_single, pts.size() == n ? "" : "  WRONG COUNT");
+  }
+}
+
+// Hull of a raw float32 file mapped and reduced chunk by chunk against copying it into a PointSet first.
+// The mapped run goes first so the peak RSS it leaves is its own.
+void BenchMapped() 
+{
+  std::mt19937 gen(42);
+  const size_t n = size_t(1) << 24;
+  const TempDir dir("convex_hull_mapped");
+  const std::string path = dir.File("points.f32");
+  {
+    // written a chunk at a time, so the file's points are never all in memory before the mapped run
+    std::ofstream file(path, std::ios::binary);
+    for (size_t done = 0; done < n; done += kHullChunk)
+    {
+      const auto block = RandomDisc(kHullChunk, gen);
+      file.write(reinterpret_cast<const char *>(block.data()), std::streamsize(block.size()*sizeof(vec2f)));
+    }
+  }
+
+  std::cout << "hull of a " << double(std::filesystem::file_size(path))/1e6 << " MB float32 file, n = " << n << "\n";
+  std::cout << "  path           ms  hull  peak rss,MB\n";
+  const double base = PeakRssMb();
+  std::vector<size_t> indices;
+  {
+    MappedPoints<float> view;
+    if (!view.Open(path))
+    {
+      std::cout << "  mapping unavailable\n";
+      return;
+    }
+    const double t = TimeMs([&] { indices = HullIndices(view, DefaultPool()); });
+    // looking the hull up in the view would fault its pages back in, the copy below answers that instead
+    std::printf("  mapped   %8.1f  %4zu  %11.1f\n", t, indices.size(), PeakRssMb());
+  }
+  std::vector<vec2f> copied_hull, mapped_hull;
+  PointSet<float> pts;
+  const double t = TimeMs([&] {
+    std::vector<char> data;
+    ReadFile(path, data);
+    pts.reserve(n);
+    for (size_t i = 0; i < n; ++i) pts.push_back(vec2f{LoadLittleEndian<float>(&data[8*i]), LoadLittleEndian<float>(&data[8*i+4])});
+    std::vector<char>().swap(data);
+    copied_hull = MonotoneChain(pts);
+  });
+  for (const size_t i : indices) mapped_hull.emplace_back(pts[i]);
+  std::printf("  copied   %8.1f  %4zu  %11.1f%s\n", t, copied_hull.size(), PeakRssMb(),
+              copied_hull == mapped_hull ? "" : "  MISMATCH");
+  std::printf("  (%.1f MB before either)\n", base);
+}
+
+// Points arriving in batches: the incremental hull taking each batch against rerunning the monotone chain
+// over everything so far, for a disc (few points reach the hull) and a circle (every point does).
+void BenchIncremental() 
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  const size_t n = size_t(1) << 19, batches = 64;
+  std::cout << "incremental hull, n = " << n << " in " << batches << " batches\n";
+  std::cout << "  input    rerun,ms  incremental,ms  ns/insert   hull\n";
+  for (const bool circle : {false, true})
+  {
+    std::vector<vec2f> pts = circle ? std::vector<vec2f>(n) : RandomDisc(n, gen);
+    if (circle)
+      for (auto &pt : pts)
+      {
+        pt = vec2f{std::cos(PI*dist(gen)), std::sin(PI*dist(gen))};
+        pt = pt*(1.0f/pt.norm());
+      }
+    std::vector<vec2f> rerun;
+    const double t_rerun = TimeMs([&] {
+      for (size_t b = 1; b <= batches; ++b) rerun = MonotoneChain(std::vector<vec2f>(pts.begin(), pts.begin()+n*b/batches));
+    });
+    IncrementalHull<float> hull;
+    const double t_insert = TimeMs([&] { for (const auto &pt : pts) hull.Insert(pt); });
+    std::printf("  %-6s  %9.1f  %14.1f  %9.1f  %5zu%s\n", circle ? "circle" : "disc", t_rerun, t_insert,
+                t_insert*1e6/double(n), hull.size(), hull.Hull() == rerun ? "" : "  MISMATCH");
+  }
+}
+
+// Mixed insert/erase workloads on the dynamic hull with n points live: a TTL window (insert the newest,
+// expire the oldest), random erasures of live points, and the TTL window over a circle, where every update
+// changes the hull. The rebuild column is one monotone chain over the live points, the price of answering
+// an expiry without the dynamic hull; the query column is one Hull() call on an unchanged hull.
+void BenchDynamic() 
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  const size_t n = 100000, ops = 1000000;
+  std::cout << "dynamic hull, " << n << " points live, " << ops << " operations\n";
+  std::cout << "  workload      ms   Mops/s  rebuild,ms  query,us  hull\n";
+  for (const char *workload : {"ttl", "random", "circle"})
+  {
+    const bool circle = std::strcmp(workload, "circle") == 0, ttl = std::strcmp(workload, "random") != 0;
+    std::vector<vec2f> fresh = circle ? std::vector<vec2f>(ops/2+n) : RandomDisc(ops/2+n, gen);
+    if (circle)
+      for (auto &pt : fresh)
+      {
+        const float ang = PI*dist(gen);
+        pt = vec2f{std::cos(ang), std::sin(ang)};
+      }
+    std::vector<size_t> picks(ops/2);
+    for (auto &i : picks) i = gen()%n;
+
+    DynamicHull<float> hull;
+    std::deque<vec2f> live(fresh.begin(), fresh.begin()+n);
+    for (const auto &pt : live) hull.Insert(pt);
+    const double t = TimeMs([&] {
+      for (size_t i = 0; i < ops/2; ++i)
+      {
+        if (ttl)
+        {
+          hull.Erase(live.front());
+          live.pop_front();
+        }
+        else
+        {
+          std::swap(live[picks[i]], live.back());
+          hull.Erase(live.back());
+          live.pop_back();
+        }
+        hull.Insert(fresh[n+i]);
+        live.push_back(fresh[n+i]);
+      }
+    });
+    std::vector<vec2f> expected;
+    const double t_rebuild = TimeMs([&] { expected = MonotoneChain(live); });
+    auto got = hull.Hull();
+    const size_t queries = 1000;
+    const double t_query = TimeMs([&] { for (size_t i = 0; i < queries; ++i) got = hull.Hull(); });
+    std::printf("  %-8s  %7.1f  %7.2f  %10.2f  %8.2f  %4zu%s\n", workload, t, double(ops)/t/1e3, t_rebuild,
+                t_query*1e3/double(queries), got.size(), got == expected ? "" : "  MISMATCH");
+  }
+}
+
+// Sliding windows of n points over a stream: the window's hull after every batch of arrivals, against one
+// monotone chain over the window's points per batch. The TTL case stamps points at a steady rate and expires
+// by age instead of by count.
+void BenchWindow() 
+{
+  std::mt19937 gen(42);
+  const size_t n = 100000, stream = 4000000, batch = 1000;
+  std::cout << "sliding window hull, " << n << " points live, " << stream << " arrivals, hull every " << batch << "\n";
+  std::cout << "  window      ms  ns/point  rebuild,ms  hull\n";
+  const std::vector<vec2f> pts = RandomDisc(stream, gen);
+  for (const bool ttl : {false, true})
+  {
+    SlidingWindowHull<float> hull;
+    size_t h = 0;
+    const double t = TimeMs([&] {
+      for (size_t i = 0; i < stream; ++i)
+      {
+        hull.Push(pts[i], double(i));
+        if (ttl) hull.ExpireBefore(double(i+1)-double(n));
+        else if (hull.size() > n) hull.Pop();
+        if ((i+1)%batch == 0) h += hull.Hull().size();
+      }
+    });
+    std::vector<vec2f> expected;
+    const double t_rebuild = TimeMs([&] { expected = MonotoneChain(std::vector<vec2f>(pts.end()-n, pts.end())); });
+    std::printf("  %-6s  %7.1f  %8.1f  %10.2f  %4zu%s\n", ttl ? "ttl" : "count", t, t*1e6/double(stream), t_rebuild,
+                expected.size(), hull.Hull() == expected && h > 0 ? "" : "  MISMATCH");
+  }
+}
+
+// Many small groups in CSR layout, 10 to 200 points each: one monotone chain per group over a vector of its
+// own, the way one hull per call goes, against BatchHulls on one thread and on the default pool.
+void BenchBatch() 
+{
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<size_t> group_size(10, 200);
+  const size_t groups = 200000;
+  std::vector<size_t> offsets{0};
+  for (size_t g = 0; g < groups; ++g) offsets.emplace_back(offsets.back()+group_size(gen));
+  const std::vector<vec2f> pts = RandomDisc(offsets.back(), gen);
+  std::cout << "batch hulls, " << groups << " groups, " << pts.size() << " points\n";
+  std::cout << "  engine         ms   ns/point\n";
+
+  std::vector<vec2f> expected;
+  std::vector<size_t> expected_offsets{0};
+  const double t_each = TimeMs([&] {
+    for (size_t g = 0; g < groups; ++g)
+    {
+      const auto hull = MonotoneChain(std::vector<vec2f>(pts.begin()+offsets[g], pts.begin()+offsets[g+1]));
+      expected.insert(expected.end(), hull.begin(), hull.end());
+      expected_offsets.emplace_back(expected.size());
+    }
+  });
+  std::printf("  per-group  %7.1f  %8.1f\n", t_each, t_each*1e6/double(pts.size()));
+
+  ThreadPool serial(1);
+  for (ThreadPool *pool : {&serial, &DefaultPool()})
+  {
+    std::vector<vec2f> hulls;
+    std::vector<size_t> hull_offsets;
+    const double t = TimeMs([&] { BatchHulls(pts.data(), offsets.data(), groups, hulls, hull_offsets, *pool); });
+    std::printf("  batch x%-2u  %7.1f  %8.1f%s\n", pool->Size(), t, t*1e6/double(pts.size()),
+                hulls == expected && hull_offsets == expected_offsets ? "" : "  MISMATCH");
+  }
+}
+
+// Streaming hull of float32 and CSV files against just reading them block by block, the bound it's after,
+// checked against the hull of every point held at once.
+void BenchStream() 
+{
+  std::mt19937 gen(42);
+  const size_t n = size_t(1) << 23;
+  const TempDir dir("convex_hull_stream");
+
+  const std::vector<vec2f> pts = RandomDisc(n, gen);
+  {
+    std::ofstream f32(dir.File("points.f32"), std::ios::binary), csv(dir.File("points.csv"), std::ios::binary);
+    f32.write(reinterpret_cast<const char *>(pts.data()), std::streamsize(pts.size()*sizeof(vec2f)));
+    std::string text;
+    char number[32];
+    for (const auto &pt : pts)
+    {
+      text.append(number, std::to_chars(number, number+sizeof(number), pt.x).ptr);
+      text += ',';
+      text.append(number, std::to_chars(number, number+sizeof(number), pt.y).ptr);
+      text += '\n';
+    }
+    csv << text;
+  }
+  const auto expected = MonotoneChain(pts);
+
+  std::cout << "streaming hull, n = " << n << ", files in the page cache\n";
+  std::cout << "  file          MB  read,ms  read,MB/s  hull,ms  hull,MB/s  hull\n";
+  for (const char *name : {"points.f32", "points.csv"})
+  {
+    const std::string path = dir.File(name);
+    const double mb = double(std::filesystem::file_size(path))/1e6;
+    const double t_read = TimeMs([&] {
+      FILE *file = std::fopen(path.c_str(), "rb");
+      BlockReader reader(file, kStreamBlock, 2);
+      std::vector<char> block;
+      while (reader.Next(block)) {}
+      std::fclose(file);
+    });
+    StreamingHull<float> hull;
+    const double t_hull = TimeMs([&] { StreamPoints(path, hull, DefaultPool()); });
+    bool match = hull.Hull() == expected && hull.Count() == n;
+    for (size_t i = 0; match && i < hull.Indices().size(); ++i) match = pts[hull.Indices()[i]] == hull.Hull()[i];
+    std::printf("  %-10s  %6.1f  %7.1f  %9.0f  %7.1f  %9.0f  %4zu%s\n", name, mb, t_read, mb/t_read*1e3, t_hull,
+                mb/t_hull*1e3, hull.Hull().size(), match ? "" : "  MISMATCH");
+  }
+}
+
+void BenchEncode() 
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> dist(-0.9f, 0.9f);
+  const int frames = 32;
+  std::vector<vec2f> pts(kSamples);
+  std::vector<float> ring, ring_centers, overlay;
+  std::vector<uint32_t> ring_colors(pts.size(), kPointColor), overlay_colors;
+  DrawPoint(vec2f{0.0f, 0.0f}, ring);
+  for (auto &pt : pts)
+  {
+    pt = {dist(gen),dist(gen)};
+    ring_centers.insert(ring_centers.end(), {pt.x, pt.y});
+  }
+  const auto hull = MonotoneChain(pts);
+  BuildOverlay(hull, vec2f{0.0f, 0.0f}, overlay, overlay_colors);
+  FrameDraws draws;
+  BuildFrame(pts.size(), hull.size(), draws);
+  SoftwareRasterizer raster(kWinWidth, kWinHeight);
+  const int stride = int(raster.Stride());
+  std::vector<unsigned char> frame(size_t(stride)*kWinHeight);
+  const std::vector<uint32_t> background;
+  auto render = [&](unsigned char *out) {
+    raster.Render(draws, FrameStreams{ring, ring_centers, ring_colors, overlay, overlay_colors, background}, out, DefaultPool());
+  };
+
+  const TempDir temp("convex_hull_bench");
+  const std::string dir = temp.Path();
+
+  // Both paths render every frame, the async one straight into the buffer it acquired as the headless loop
+  // does; only what saving costs the render thread is timed: the whole encode when saving synchronously,
+  // waiting for a free buffer and queueing it through the writer.
+  double t_render = 0.0, t_sync = 0.0;
+  for (int f = 0; f < frames; ++f)
+  {
+    t_render += TimeMs([&] { render(frame.data()); });
+    t_sync += TimeMs([&] { SaveFrame(dir, f, frame.data(), stride); });
+  }
+  double t_handoff = 0.0, t_total = 0.0;
+  {
+    FrameWriter writer(dir, kEncoderThreads, kFrameBuffers, frame.size(), false);
+    t_total = TimeMs([&] {
+      for (int f = 0; f < frames; ++f)
+      {
+        FrameWriter::Frame *buffer = nullptr;
+        t_handoff += TimeMs([&] { buffer = writer.Acquire(); });
+        render(buffer->data());
+        t_handoff += TimeMs([&] { writer.Submit(f, buffer, stride); });
+      }
+      writer.Flush();
+    });
+  }
+
+  std::cout << "png encoding, " << frames << " frames, " << kEncoderThreads << " encoders, " << kFrameBuffers << " buffers\n";
+  std::printf("  render  %7.2f ms/frame\n", t_render/frames);
+  std::printf("  sync    %7.2f ms/frame on the render thread\n", t_sync/frames);
+  std::printf("  async   %7.2f ms/frame on the render thread, %.2f ms/frame overall with rendering\n", t_handoff/frames,
+              t_total/frames);
+}
+
+int RunBenchmarks(const std::string &filter) 
+{
+  headless = true;
+  if (filter.empty() || filter == "wrap") BenchWrapStep();
+  if (filter.empty() || filter == "robust") BenchRobust();
+  if (filter.empty() || filter == "chan") BenchChan();
+  if (filter.empty() || filter == "prefilter") BenchPrefilter();
+  if (filter.empty() || filter == "parallel") BenchParallel();
+  if (filter.empty() || filter == "coords") BenchCoordinates();
+  if (filter.empty() || filter == "points") BenchPointLayer();
+  if (filter.empty() || filter == "vertices") BenchVertices();
+  if (filter.empty() || filter == "overlay") BenchOverlay();
+  if (filter.empty() || filter == "raster") BenchRaster();
+  if (filter.empty() || filter == "lod") BenchLod();
+  if (filter.empty() || filter == "load") BenchLoad();
+  if (filter.empty() || filter == "mapped") BenchMapped();
+  if (filter.empty() || filter == "stream") BenchStream();
+  if (filter.empty() || filter == "incremental") BenchIncremental();
+  if (filter.empty() || filter == "dynamic") BenchDynamic();
+  if (filter.empty() || filter == "window") BenchWindow();
+  if (filter.empty() || filter == "batch") BenchBatch();
+  if (filter.empty() || filter == "encode") BenchEncode();
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  stbi_flip_vertically_on_write(true);
+  bool run_headless = false;
+  std::string hull_path;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    if (arg == "--bench") return RunBenchmarks(i+1 < argc ? argv[i+1] : "");
+    else if (arg == "--headless") run_headless = true;
+    else if (arg == "--input" && i+1 < argc) input_path = argv[++i];
+    else if (arg == "--stream") stream_input = true;
+    else if (arg == "--format" && i+1 < argc && (argv[i+1] == std::string("text") || argv[i+1] == std::string("f32") ||
+                                                  argv[i+1] == std::string("f64"))) input_format = argv[++i];
+    else if (arg == "--hull" && i+1 < argc) hull_path = argv[++i];
+    else
+    {
+      std::cerr << "usage: " << argv[0] << " [--headless] [--input points.csv|.tsv|.txt|.f32|.f64|- [--stream]]"
+                << " | --hull points.csv|.f32|.f64|- | --bench [filter]\n"
+                << "  --format text|f32|f64 overrides the file extension, --stream keeps only the input's hull\n";
+      return 1;
+    }
+  }
+  if (!hull_path.empty()) return RunHull(hull_path);
+  if (run_headless) return RunHeadless();
+
+  MakeWindow(kWinHeight, kWinWidth, "ConvexHull");
+
+  glGenVertexArrays(1, &VAO);
+  glGenBuffers(1, &VBO);
+  glGenBuffers(1, &VBOc);
+  glGenBuffers(1, &VBOcc);
+  glGenVertexArrays(1, &VAOd);
+  glGenBuffers(1, &VBOd);
+  glGenBuffers(1, &VBOdc);
+  glGenVertexArrays(1, &VAOh);
+  glGenTextures(1, &heatmap_texture);
+  overlay_buffer.Attach(VAOd, VBOd, VBOdc);
+
+  if (!SetupScene())
+  {
+    glfwTerminate();
+    return 1;
+  }
+
+  double prev_time = -kAnime;
+
+  int k = 0;
+  int k_saved = 0;
+  FrameDraws draws;
+
+  GLsizei channels = 3;
+  GLsizei stride = channels * kWinWidth;
+  stride += (stride % 4) ? (4 - stride % 4) : 0;
+  FrameWriter writer(out_dir, kEncoderThreads, kFrameBuffers, size_t(stride)*kWinHeight);
+  std::unique_ptr<PboCapture> capture;
+  if (kPboCapture) capture = std::make_unique<PboCapture>(writer, kPboSlots, stride, size_t(stride)*kWinHeight);
+
+  while (!glfwWindowShouldClose(window))
+  {
+    double current_time = glfwGetTime();
+    if (current_time-kAnime >= prev_time) 
+    {
+      k += int(SolverAdvance());
+      prev_time = current_time;
+      if (center_colors_changed) UploadCenterColors(VAO, VBOcc, center_colors);
+      center_colors_changed = false;
     }
 
     glClear(GL_COLOR_BUFFER_BIT);
+    if (lod)
+    {
+      glUseProgram(heatmap_program);
+      glBindVertexArray(VAOh);
+      glBindTexture(GL_TEXTURE_2D, heatmap_texture);
+      glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
     glUseProgram(shader_program);
-    unsigned int color_uniform = glGetUniformLocation(shader_program, "color");
-
-    glBindVertexArray(VAO);
-    glUniform4f(color_uniform, 1.0f, 1.0f, 1.0f, 1.0f);
-    for (unsigned int i = 0; i < kSamples; i++)
-      glDrawArrays(GL_TRIANGLE_STRIP, 4*i*kPointNodes, 4*kPointNodes);
-
-    glBindVertexArray(VAOd); 
-    // draw seg lines
-    glUniform4f(color_uniform, 0.0f, 1.0f, 0.0f, 1.0f);
-    const unsigned int segments = (unsigned int)(line_segments.size());
-    const unsigned int points_vertices = 4*(segments+1)*kPointNodes;
-    for (unsigned int i = 0; i < line_segments.size()-1; i++)
-      glDrawArrays(GL_TRIANGLE_STRIP,  points_vertices+i*4, 4); 
-    // draw last line 
-    glUniform4f(color_uniform, 1.0f, 0.0f, 1.0f, 0.1f);
-      glDrawArrays(GL_TRIANGLE_STRIP,  points_vertices+(segments-1)*4, 4); 
-    // draw seg points
-    glUniform4f(color_uniform, 0.0f, 1.0f, 0.0f, 1.0f);
-    for (unsigned int i = 0; i < line_segments.size()-1; i++)
-      glDrawArrays(GL_TRIANGLE_STRIP, 4*i*kPointNodes, 4*kPointNodes);
-    // draw last seg point + mean
-    glUniform4f(color_uniform, 1.0f, 0.0f, 1.0f, 0.1f); 
-    glDrawArrays(GL_TRIANGLE_STRIP, 4*(segments-1)*kPointNodes, 4*kPointNodes); 
-    glDrawArrays(GL_TRIANGLE_STRIP, 4*segments*kPointNodes, 4*kPointNodes);     
+
+    BuildFrame(centers.size()/2, line_segments.size(), draws);
+    if (draws.instances > 0)
+    {
+      glBindVertexArray(VAO);
+      glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, GLsizei(kRingVertices), GLsizei(draws.instances));
+    }
+    if (!draws.first.empty())
+    {
+      glBindVertexArray(VAOd);
+      glMultiDrawArrays(GL_TRIANGLE_STRIP, draws.first.data(), draws.count.data(), GLsizei(draws.first.size()));
+    }
 
     glfwSwapBuffers(window);
     // save 
     if (k != k_saved) 
     {
-      GLsizei channels = 3;
-		  GLsizei stride = channels * kWinWidth;
-		  stride += (stride % 4) ? (4 - stride % 4) : 0;
-		  GLsizei bufferSize = stride * kWinHeight;
-		  std::vector<char> buffer(bufferSize);
-		  glPixelStorei(GL_PACK_ALIGNMENT, 4);
 		  glReadBuffer(GL_FRONT);
-		  glReadPixels(0, 0, kWinWidth, kWinHeight, GL_RGB, GL_UNSIGNED_BYTE, buffer.data());
-		  stbi_flip_vertically_on_write(true);
-		  stbi_write_png((out_dir+"/"+std::to_string(k)+std::string(".png")).c_str(),
-										  kWinWidth, kWinHeight, channels, buffer.data(), stride);
-      std::cout << (out_dir+"/"+std::to_string(k)+std::string(".png")) << "\n";
+      if (capture) capture->Capture(k);
+      else
+      {
+        FrameWriter::Frame *frame = writer.Acquire();
+		    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		    glReadPixels(0, 0, kWinWidth, kWinHeight, GL_RGB, GL_UNSIGNED_BYTE, frame->data());
+        writer.Submit(k, frame, stride);
+      }
       k_saved = k;
     }
+    if (capture) capture->Poll();
     glfwPollEvents();
   }
+  capture.reset();
 
   glDeleteVertexArrays(1, &VAO);
   glDeleteBuffers(1, &VBO);
+  glDeleteBuffers(1, &VBOc);
+  glDeleteBuffers(1, &VBOcc);
   glDeleteVertexArrays(1, &VAOd);
   glDeleteBuffers(1, &VBOd);
+  glDeleteBuffers(1, &VBOdc);
+  glDeleteVertexArrays(1, &VAOh);
+  glDeleteTextures(1, &heatmap_texture);
+  glDeleteProgram(heatmap_program);
   glDeleteProgram(shader_program);
 
   glfwTerminate();